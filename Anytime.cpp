@@ -0,0 +1,229 @@
+#include "Anytime.hpp"
+#include "Network.hpp"
+#include "Neuron.hpp"
+#include "Environment.hpp"
+#include "Executor.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <boost/thread/thread.hpp>
+#include <boost/bind/bind.hpp>
+
+namespace ESP {
+
+ChampionBuffer::ChampionBuffer(Network& n) : back(0), front(1), middle(2) {
+	if (!n.created) {
+		std::cerr << "ChampionBuffer needs a created Network; ChampionBuffer::ChampionBuffer" << std::endl;
+		abort();
+	}
+	for (int i = 0; i < 3; ++i) {
+		slots[i] = n.clone();
+		*slots[i] = n;
+	}
+}
+
+ChampionBuffer::~ChampionBuffer() {
+	for (int i = 0; i < 3; ++i) {
+		delete slots[i];
+	}
+}
+
+/*!
+ * Copy the weights of n into slot in place
+ * Only done when both have the same number of dense Neurons of the
+ * same sizes, so no Neuron or weight vector is allocated or freed. Returns false,
+ * leaving slot untouched, if the shapes differ
+ */
+bool ChampionBuffer::copyWeights(Network* slot, Network& n) {
+	if (&slot->getDescriptor() != &n.getDescriptor() || slot->hiddenUnits.size() != n.hiddenUnits.size()) {
+		return false;
+	}
+	for (unsigned int i = 0; i < n.hiddenUnits.size(); ++i) {
+		Neuron* to = slot->hiddenUnits[i];
+		Neuron* from = n.hiddenUnits[i];
+		if (!to->isDense() || !from->isDense() || to->weight.size() != from->weight.size()) {
+			return false;
+		}
+	}
+	for (unsigned int i = 0; i < n.hiddenUnits.size(); ++i) {
+		Neuron* to = slot->hiddenUnits[i];
+		Neuron* from = n.hiddenUnits[i];
+		std::copy(from->weight.begin(), from->weight.end(), to->weight.begin());
+		to->id = from->id;
+		to->parent1 = from->parent1;
+		to->parent2 = from->parent2;
+		to->fitness = from->fitness;
+		to->trials = from->trials;
+		to->lesioned = from->lesioned;
+		if (from->objectives && to->objectives) {
+			*to->objectives = *from->objectives;
+		} else if (from->objectives || to->objectives) {
+			delete to->objectives;
+			to->objectives = from->objectives ? new std::vector<double>(*from->objectives) : 0;
+		}
+	}
+	slot->fitness = n.fitness;
+	slot->trials = n.trials;
+	slot->parent1 = n.parent1;
+	slot->parent2 = n.parent2;
+	slot->objectives = n.objectives;
+	slot->bias = n.bias;
+	slot->activation = n.activation;
+	return true;
+}
+
+/*!
+ * Publish a new best Network
+ * Called from the evolving thread only. As long as the champion
+ * keeps the shape of the slots its weights are copied into them;
+ * otherwise the slot is reassigned, which reallocates its Neurons
+ */
+void ChampionBuffer::publish(Network& n) {
+	if (!copyWeights(slots[back], n)) {
+		*slots[back] = n;
+	}
+	back = middle.exchange(back | dirty, boost::memory_order_acq_rel) & ~dirty;
+}
+
+/*!
+ * Latest published Network
+ * Called from the consumer thread only. The Network stays valid and
+ * unchanged until the next call
+ */
+Network* ChampionBuffer::acquire() {
+	if (middle.load(boost::memory_order_acquire) & dirty) {
+		front = middle.exchange(front, boost::memory_order_acq_rel) & ~dirty;
+	}
+	return slots[front];
+}
+
+DeadlineController::DeadlineController(double b, std::vector<NeuronPop*>& s, boost::mt19937& r) : safety(0.9),
+																								  minTrials(1),
+																								  maxTrials(10),
+																								  minSize(8),
+																								  maxSize(100),
+																								  minThreads(1),
+																								  budget(b),
+																								  subpops(s),
+																								  rng(r),
+																								  latency(0.0),
+																								  cost(0.0),
+																								  trials(1),
+																								  threads(1) {
+	if (subpops.empty() || budget <= 0.0) {
+		std::cerr << "DeadlineController needs subpopulations and a positive budget; DeadlineController::DeadlineController" << std::endl;
+		abort();
+	}
+	for (unsigned int i = 0; i < subpops.size(); ++i) {
+		if (subpops[i]->getNumIndividuals() == 0) {
+			std::cerr << "Subpopulation " << i << " is empty; DeadlineController::DeadlineController" << std::endl;
+			abort();
+		}
+	}
+	maxThreads = std::max(1u, boost::thread::hardware_concurrency());
+	subpopSize = subpops[0]->getNumIndividuals();
+	breedRatio = (double)subpops[0]->getNumBreed() / subpopSize;
+	maxSize = std::max(maxSize, subpopSize);
+}
+
+void DeadlineController::startGeneration() {
+	start = Clock::now();
+}
+
+/*!
+ * Seconds since startGeneration
+ */
+double DeadlineController::elapsed() {
+	return boost::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/*!
+ * Whether the generation has used up its budget
+ */
+bool DeadlineController::expired() {
+	return elapsed() >= budget;
+}
+
+/*!
+ * Evaluate Networks taken from cursor with envt until the budget expires
+ */
+void DeadlineController::runChunk(std::vector<Network*>* nets, Environment* envt, boost::atomic<int>* cursor) {
+	while (!expired()) {
+		int k = cursor->fetch_add(1);
+		if (k >= (int)nets->size()) {
+			return;
+		}
+		envt->evaluateEpisodes((*nets)[k]);
+	}
+}
+
+/*!
+ * Evaluate the Networks of a generation within the budget
+ * Called between startGeneration and endGeneration. Runs one task
+ * per evaluation thread on the Executor, each with its own
+ * Environment, so at most getThreads() Networks are evaluated at
+ * once, on the common episodes of the generation. The Networks are
+ * handed out in order and none is started once the budget has
+ * expired, so the ones evaluated are the first ones. Returns their
+ * number, which is what endGeneration expects
+ */
+int DeadlineController::evaluate(std::vector<Network*>& nets, std::vector<Environment*>& envts, Executor& executor) {
+	if (envts.empty()) {
+		std::cerr << "No Environment to evaluate with; DeadlineController::evaluate" << std::endl;
+		abort();
+	}
+	threads = std::min(threads, (int)envts.size());
+	boost::atomic<int> cursor(0);
+	std::vector<boost::function<void()> > tasks;
+	for (int c = 0; c < threads; ++c) {
+		tasks.push_back(boost::bind(&DeadlineController::runChunk, this, &nets, envts[c], &cursor));
+	}
+	executor.runAll(tasks);
+	return std::min(cursor.load(), (int)nets.size());
+}
+
+/*!
+ * Adapt the next generation to the measured latency
+ * Takes the number of evaluations run in the generation. The
+ * subpopulations must be sorted, so shrinking drops the worst
+ * Neurons
+ */
+void DeadlineController::endGeneration(int evaluations) {
+	latency = elapsed();
+	if (evaluations <= 0) {
+		return;
+	}
+	double c = latency * threads / evaluations;
+	cost = cost > 0.0 ? 0.5 * cost + 0.5 * c : c;
+	// Evaluations one thread can run within the budget
+	double capacity = safety * budget / cost;
+	double largest = (double)maxSize * maxTrials;
+	threads = std::max(1, minThreads);
+	while (threads < maxThreads && capacity * threads < largest) {
+		++threads;
+	}
+	double work = capacity * threads;
+	trials = std::max(minTrials, std::min(maxTrials, (int)(work / subpopSize)));
+	subpopSize = std::max(1, std::max(minSize, std::min(maxSize, (int)(work / trials))));
+	resize();
+}
+
+/*!
+ * Bring every subpopulation to subpopSize
+ */
+void DeadlineController::resize() {
+	for (unsigned int i = 0; i < subpops.size(); ++i) {
+		NeuronPop* pop = subpops[i];
+		while ((int)pop->getNumIndividuals() > subpopSize) {
+			pop->popIndividual();
+		}
+		while ((int)pop->getNumIndividuals() < subpopSize) {
+			Neuron* n = pop->getIndividual(0)->clone();
+			n->create(rng);
+			pop->pushIndividual(n);
+		}
+		pop->setNumBreed(std::max(1, (int)(breedRatio * subpopSize)));
+	}
+}
+
+}
@@ -0,0 +1,88 @@
+#ifndef _ANYTIME_HPP_
+#define _ANYTIME_HPP_
+
+#include "Population.hpp"
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
+
+namespace ESP {
+
+class Network;
+class Environment;
+class Executor;
+
+/*!
+ * Lock-free handoff of the best Network to a consumer thread
+ * Triple buffer of three preallocated copies of a created Network.
+ * The evolving thread publishes into the back copy and swaps it
+ * with the middle one; the consumer swaps the middle copy into the
+ * front when it is newer. Neither side ever waits, and since all
+ * three copies are filled before the first generation acquire
+ * always returns a valid Network. Only one thread may publish and
+ * only one thread may acquire
+ */
+class ChampionBuffer {
+public:
+	ChampionBuffer(Network&);
+	~ChampionBuffer();
+	void publish(Network&);
+	Network* acquire();
+private:
+	static const int dirty = 4;	///< Set in middle when it holds a Network the consumer has not seen
+	Network* slots[3];
+	int back;					///< Slot written by the publisher
+	int front;					///< Slot read by the consumer
+	boost::atomic<int> middle;	///< Slot in transit, possibly or'ed with dirty
+	static bool copyWeights(Network*, Network&);
+};
+
+/*!
+ * Keeps each generation within a wall-clock budget
+ * Measures the latency of every generation and keeps a smoothed
+ * estimate of the cost of one evaluation. From it the controller
+ * picks, for the next generation, the fewest evaluation threads
+ * that fit the largest workload, then the trials per Neuron and
+ * the subpopulation size that fill the budget. Subpopulations grow
+ * with new random Neurons, drawn from the generator the controller
+ * is given, and shrink by dropping their worst ones, but never
+ * below one Neuron. evaluate runs a generation's Networks on at most
+ * getThreads() Environments at once and stops starting new ones once
+ * the budget has expired; a loop of its own should stop early once
+ * expired returns true
+ */
+class DeadlineController {
+public:
+	DeadlineController(double budget, std::vector<NeuronPop*>&, boost::mt19937&);
+	void startGeneration();
+	void endGeneration(int evaluations);
+	bool expired();
+	int evaluate(std::vector<Network*>&, std::vector<Environment*>&, Executor&);
+	double elapsed();
+	inline int getTrials() { return trials; };
+	inline int getThreads() { return threads; };
+	inline int getSubpopSize() { return subpopSize; };
+	inline double getLatency() { return latency; };
+	double safety;				///< Fraction of the budget the controller aims for
+	int minTrials, maxTrials;
+	int minSize, maxSize;		///< Bounds on the subpopulation size
+	int minThreads, maxThreads;	///< Bounds on the evaluation threads, also capped by the Environments given to evaluate
+private:
+	typedef boost::chrono::steady_clock Clock;
+	double budget;				///< Target generation latency in seconds
+	std::vector<NeuronPop*>& subpops;
+	boost::mt19937& rng;		///< Generator of the new Neurons, usually NeuroEvolution::rng
+	double breedRatio;			///< Fraction of each subpopulation that breeds
+	Clock::time_point start;
+	double latency;				///< Latency of the last generation
+	double cost;				///< Smoothed seconds per evaluation on one thread, 0 before the first generation
+	int trials;
+	int threads;
+	int subpopSize;
+	void resize();
+	void runChunk(std::vector<Network*>*, Environment*, boost::atomic<int>*);
+};
+
+}
+
+#endif
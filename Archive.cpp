@@ -0,0 +1,187 @@
+#include "Archive.hpp"
+#include "Neuron.hpp"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <boost/interprocess/exceptions.hpp>
+
+namespace ESP {
+
+static const char ARCHIVE_MAGIC[4] = { 'E', 'S', 'P', 'A' };
+static const int ARCHIVE_VERSION = 1;
+
+/*!
+ * Open an archive
+ * Maps the file read-only and validates its header. No Neurons
+ * are created until they are accessed
+ */
+PopulationArchive::PopulationArchive(std::string fname) : header(0) {
+	using namespace boost::interprocess;
+	try {
+		file_mapping f(fname.c_str(), read_only);
+		mapped_region r(f, read_only);
+		file.swap(f);
+		region.swap(r);
+	} catch (interprocess_exception& e) {
+		std::cerr << "Error - cannot map " << fname << ": " << e.what() << "; PopulationArchive::PopulationArchive" << std::endl;
+		return;
+	}
+	const Header* h = static_cast<const Header*>(region.get_address());
+	if (region.get_size() < sizeof(Header) || memcmp(h->magic, ARCHIVE_MAGIC, 4) != 0 || h->version != ARCHIVE_VERSION
+		|| h->numIndividuals < 0 || h->geneSize < 0) {
+		std::cerr << "Error - " << fname << " is not a Population archive; PopulationArchive::PopulationArchive" << std::endl;
+		return;
+	}
+	if ((region.get_size() - sizeof(Header)) / stride(h->geneSize) < (size_t)h->numIndividuals) {
+		std::cerr << "Error - " << fname << " is truncated; PopulationArchive::PopulationArchive" << std::endl;
+		return;
+	}
+	header = h;
+	cache.resize(header->numIndividuals, 0);
+	issued.resize(header->numIndividuals, false);
+	// New Neurons must never reuse an archived ID
+	int last = 0;
+	for (int i = 0; i < header->numIndividuals; ++i) {
+		last = std::max(last, record(i)->id);
+	}
+	Neuron::reserveIDs(last);
+}
+
+PopulationArchive::~PopulationArchive() {
+	for (unsigned int i = 0; i < cache.size(); ++i) {
+		delete cache[i];
+	}
+}
+
+/*!
+ * Size in bytes of a Record and its weights
+ */
+size_t PopulationArchive::stride(int geneSize) {
+	return sizeof(Record) + (size_t)geneSize * sizeof(double);
+}
+
+int PopulationArchive::getGeneSize() {
+	return header ? header->geneSize : 0;
+}
+
+const PopulationArchive::Record* PopulationArchive::record(int i) {
+	if (i < 0 || i >= (int)cache.size()) {
+		std::cerr << "Index out of bounds; PopulationArchive::record" << std::endl;
+		abort();
+	}
+	const char* base = reinterpret_cast<const char*>(header + 1);
+	return reinterpret_cast<const Record*>(base + (size_t)i * stride(header->geneSize));
+}
+
+/*!
+ * Read-only view of the weights of an archived Neuron
+ * Does not materialize the Neuron
+ */
+const double* PopulationArchive::getWeights(int i) {
+	return reinterpret_cast<const double*>(record(i) + 1);
+}
+
+double PopulationArchive::getFitness(int i) {
+	const Record* r = record(i);
+	return r->trials ? r->fitness / (double)r->trials : r->fitness;
+}
+
+int PopulationArchive::getID(int i) {
+	return record(i)->id;
+}
+
+/*!
+ * Create a private copy of an archived Neuron
+ * The copy keeps the archived ID the first time the Neuron is
+ * materialized; later copies, e.g. from loading the archive a
+ * second time, get fresh IDs so that no two live Neurons share one
+ */
+Neuron* PopulationArchive::materialize(int i) {
+	const Record* r = record(i);
+	const double* w = getWeights(i);
+	Neuron* n = new Neuron(header->geneSize);
+	std::copy(w, w + header->geneSize, n->weight.begin());
+	if (issued[i]) {
+		n->newID();
+	} else {
+		n->id = r->id;
+		issued[i] = true;
+	}
+	n->parent1 = r->parent1;
+	n->parent2 = r->parent2;
+	n->trials = r->trials;
+	n->fitness = r->fitness;
+	return n;
+}
+
+/*!
+ * Access an archived Neuron
+ * The Neuron is materialized on first access and owned by the archive
+ */
+Neuron* PopulationArchive::operator[](int i) {
+	record(i);
+	if (!cache[i]) {
+		cache[i] = materialize(i);
+	}
+	return cache[i];
+}
+
+/*!
+ * Load the archive into a live Population
+ * This is a full copy, not a lazy restart: Neurons that were
+ * already accessed are handed over as they are and the rest are
+ * materialized, so loading copies every weight and is linear in
+ * the size of the archive. Neurons own their weight vectors and
+ * cannot share the read-only mapping; callers that only inspect
+ * an archive should use operator[] or getWeights, which stay lazy.
+ * The Population takes ownership of all the Neurons; the archive
+ * itself is left untouched and can be loaded again
+ */
+void PopulationArchive::load(NeuronPop& pop) {
+	std::vector<Neuron*> individuals(cache.size());
+	for (unsigned int i = 0; i < cache.size(); ++i) {
+		individuals[i] = cache[i] ? cache[i] : materialize(i);
+		cache[i] = 0;
+	}
+	pop.setIndividuals(individuals);
+}
+
+/*!
+ * Write a Population of Neurons to an archive
+ * All the Neurons must have the same number of weights
+ */
+bool PopulationArchive::save(NeuronPop& pop, std::string fname) {
+	std::ofstream file(fname.c_str(), std::ofstream::out | std::ofstream::binary);
+	if (!file) {
+		std::cerr << "Error - cannot open " << fname << "; PopulationArchive::save" << std::endl;
+		return false;
+	}
+	Header h;
+	memcpy(h.magic, ARCHIVE_MAGIC, 4);
+	h.version = ARCHIVE_VERSION;
+	h.numIndividuals = pop.getNumIndividuals();
+	h.geneSize = h.numIndividuals ? pop.getIndividual(0)->getSize() : 0;
+	file.write(reinterpret_cast<const char*>(&h), sizeof(Header));
+	for (int i = 0; i < h.numIndividuals; ++i) {
+		Neuron* n = pop.getIndividual(i);
+		if ((int)n->getSize() != h.geneSize) {
+			std::cerr << "Neurons of different size; PopulationArchive::save" << std::endl;
+			abort();
+		}
+		Record r;
+		r.id = n->id;
+		r.parent1 = n->parent1;
+		r.parent2 = n->parent2;
+		r.trials = n->trials;
+		r.fitness = n->fitness;
+		file.write(reinterpret_cast<const char*>(&r), sizeof(Record));
+		if (h.geneSize) {
+			file.write(reinterpret_cast<const char*>(&n->weight[0]), h.geneSize * sizeof(double));
+		}
+	}
+	file.close();
+	return !file.fail();
+}
+
+}
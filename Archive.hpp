@@ -0,0 +1,61 @@
+#ifndef _ARCHIVE_HPP_
+#define _ARCHIVE_HPP_
+
+#include "Population.hpp"
+#include <string>
+#include <vector>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace ESP {
+
+class Neuron;
+
+/*!
+ * On-disk Population of Neurons
+ * The archive file is mapped read-only and Neurons are only
+ * materialized when they are accessed, so opening an archive
+ * costs the same regardless of its size. The mapped file is
+ * never written to; materialized Neurons are private copies
+ * that can be loaded into a live Population
+ */
+class PopulationArchive {
+public:
+	PopulationArchive(std::string);
+	~PopulationArchive();
+	static bool save(NeuronPop&, std::string);
+	Neuron* operator[](int);
+	void load(NeuronPop&);
+	const double* getWeights(int);
+	double getFitness(int);
+	int getID(int);
+	inline bool isOpen() { return header != 0; };
+	inline unsigned int getNumIndividuals() { return cache.size(); };
+	int getGeneSize();
+private:
+	struct Header {
+		char magic[4];
+		int version;
+		int numIndividuals;
+		int geneSize;
+	};
+	struct Record {
+		int id;
+		int parent1;
+		int parent2;
+		int trials;
+		double fitness;
+	};
+	boost::interprocess::file_mapping file;
+	boost::interprocess::mapped_region region;
+	const Header* header;
+	std::vector<Neuron*> cache;		///< Materialized Neurons, 0 if not yet accessed
+	std::vector<bool> issued;		///< Whether the archived ID of a Neuron was already handed out
+	const Record* record(int);
+	Neuron* materialize(int);
+	static size_t stride(int);
+};
+
+}
+
+#endif
@@ -0,0 +1,63 @@
+#include "BatchEnvironment.hpp"
+#include "Network.hpp"
+#include <iostream>
+#include <algorithm>
+
+namespace ESP {
+
+BatchEnvironment::BatchEnvironment(int l, int steps) : lanes(l),
+													   maxSteps(steps),
+													   alive(l),
+													   laneFitness(l) {
+	if (lanes <= 0) {
+		std::cerr << "Number of lanes must be positive; BatchEnvironment::BatchEnvironment" << std::endl;
+		abort();
+	}
+}
+
+int BatchEnvironment::numAlive() {
+	int n = 0;
+	for (int i = 0; i < lanes; ++i) {
+		n += alive[i] ? 1 : 0;
+	}
+	return n;
+}
+
+/*!
+ * Single episode input
+ * Gathers the inputs of all the lanes and returns those of the first
+ */
+void BatchEnvironment::setupInput(std::vector<double>& input) {
+	inputs.resize(lanes * inputDimension);
+	setupInputs(inputs);
+	input.assign(inputs.begin(), inputs.begin() + inputDimension);
+}
+
+/*!
+ * Evaluate a Network on a batch of episodes
+ * resetLanes must set up the state of every lane; it is given the
+ * episode seed, or 0 for a fresh episode, and must derive the
+ * states of the lanes from the seed when there is one. stepLanes advances every lane by one step with
+ * the given outputs, adds the reward of the live lanes to
+ * laneFitness and clears alive for the lanes that terminated
+ */
+double BatchEnvironment::evalNet(Network* net) {
+	inputs.resize(lanes * inputDimension);
+	outputs.resize(lanes * outputDimension);
+	std::fill(alive.begin(), alive.end(), 1);
+	std::fill(laneFitness.begin(), laneFitness.end(), 0.0);
+	unsigned int seed = getEpisodeSeed();
+	resetLanes(hasEpisodeSeed() ? &seed : 0);
+	for (int step = 0; step < maxSteps && numAlive() > 0; ++step) {
+		setupInputs(inputs);
+		net->activateBatch(inputs, outputs, lanes);
+		stepLanes(outputs);
+	}
+	double sum = 0.0;
+	for (int i = 0; i < lanes; ++i) {
+		sum += laneFitness[i];
+	}
+	return sum / lanes;
+}
+
+}
@@ -0,0 +1,44 @@
+#ifndef _BATCHENVIRONMENT_HPP_
+#define _BATCHENVIRONMENT_HPP_
+
+#include "Environment.hpp"
+#include <vector>
+
+namespace ESP {
+
+class Network;
+
+/*!
+ * Environment that steps many episodes together
+ * Holds the state of a batch of episodes (lanes) in structure of
+ * arrays form. Every step the inputs of all the lanes are gathered
+ * into one row-major block, the Network is activated on the whole
+ * block and all the lanes are stepped together. Lanes that have
+ * terminated are masked out; their state is still stepped, so the
+ * stepping code stays branch free, but their fitness is frozen.
+ * The fitness of an evaluation is the mean fitness of the lanes
+ */
+class BatchEnvironment : public Environment {
+public:
+	BatchEnvironment(int lanes, int maxSteps);
+	virtual ~BatchEnvironment() {};
+	inline int getLanes() { return lanes; };
+protected:
+	int lanes;					///< Number of episodes stepped together
+	int maxSteps;				///< Maximum number of steps of an episode
+	std::vector<char> alive;	///< Lane mask, 0 once a lane has terminated
+	std::vector<double> laneFitness;	///< Fitness accumulated by each lane
+	virtual void resetLanes(const unsigned int*) = 0;
+	virtual void setupInputs(std::vector<double>&) = 0;
+	virtual void stepLanes(const std::vector<double>&) = 0;
+	virtual void setupInput(std::vector<double>&);
+	virtual double evalNet(Network*);
+	int numAlive();
+private:
+	std::vector<double> inputs;
+	std::vector<double> outputs;
+};
+
+}
+
+#endif
@@ -0,0 +1,158 @@
+#include "CodeGen.hpp"
+#include "FeedForward.hpp"
+#include "Neuron.hpp"
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+
+namespace ESP {
+
+/*!
+ * Write the weight matrices of a Network as constexpr arrays
+ */
+static void writeWeights(FILE* file, Network* net) {
+	int hid = net->getNumNeurons();
+	fprintf(file, "constexpr double hiddenWeights[%d][%d] = {\n", hid, net->numInputs);
+	for (int i = 0; i < hid; ++i) {
+		Neuron* n = net->getNeuron(i);
+		fprintf(file, "\t{ ");
+		for (int j = 0; j < net->numInputs; ++j) {
+			fprintf(file, "%.17g%s", n->lesioned ? 0.0 : n->getWeight(j), j + 1 < net->numInputs ? ", " : " ");
+		}
+		fprintf(file, "},\n");
+	}
+	fprintf(file, "};\n\n");
+	fprintf(file, "constexpr double outputWeights[%d][%d] = {\n", net->numOutputs, hid);
+	for (int j = 0; j < net->numOutputs; ++j) {
+		fprintf(file, "\t{ ");
+		for (int i = 0; i < hid; ++i) {
+			Neuron* n = net->getNeuron(i);
+			fprintf(file, "%.17g%s", n->lesioned ? 0.0 : n->getWeight(net->numInputs + j), i + 1 < hid ? ", " : " ");
+		}
+		fprintf(file, "},\n");
+	}
+	fprintf(file, "};\n\n");
+}
+
+/*!
+ * Write the Network as a C++ header
+ * Generates namespace name with constants numInputs, numHidden and
+ * numOutputs, the weight arrays and activate(const double*, double*).
+ * Lesioned Neurons and zero weights are left out of the forward pass
+ */
+bool exportNetwork(Network* net, std::string fname, std::string name) {
+	if (&net->getDescriptor() != &FeedForwardNetwork::descriptor) {
+		std::cerr << "Cannot export a " << net->getName() << "; exportNetwork" << std::endl;
+		return false;
+	}
+	int hid = net->getNumNeurons();
+	for (int i = 0; i < hid; ++i) {
+		if (!net->getNeuron(i)->isDense()) {
+			std::cerr << "Neuron " << i << " is sparse; exportNetwork" << std::endl;
+			return false;
+		}
+		if ((int)net->getNeuron(i)->getSize() < net->numInputs + net->numOutputs) {
+			std::cerr << "Neuron " << i << " is too small for a feed-forward Network; exportNetwork" << std::endl;
+			return false;
+		}
+	}
+	FILE* file = fopen(fname.c_str(), "w");
+	if (!file) {
+		std::cerr << "Error - cannot open " << fname << "; exportNetwork" << std::endl;
+		return false;
+	}
+	fprintf(file, "// Network %d exported by ESP; do not edit\n", net->getID());
+	fprintf(file, "#ifndef _%s_NETWORK_HPP_\n#define _%s_NETWORK_HPP_\n\n", name.c_str(), name.c_str());
+	fprintf(file, "#include <cmath>\n\nnamespace %s {\n\n", name.c_str());
+	fprintf(file, "constexpr int numInputs = %d;\n", net->numInputs);
+	fprintf(file, "constexpr int numHidden = %d;\n", hid);
+	fprintf(file, "constexpr int numOutputs = %d;\n\n", net->numOutputs);
+	writeWeights(file, net);
+	fprintf(file, "inline double sigmoid(double x) {\n\treturn 1.0 / (1.0 + std::exp(-x));\n}\n\n");
+	fprintf(file, "inline void activate(const double* in, double* out) {\n");
+	for (int i = 0; i < hid; ++i) {
+		Neuron* n = net->getNeuron(i);
+		if (n->lesioned) {
+			continue;
+		}
+		fprintf(file, "\tconst double h%d = sigmoid(0.0", i);
+		for (int j = 0; j < net->numInputs; ++j) {
+			if (n->getWeight(j) != 0.0) {
+				fprintf(file, " + hiddenWeights[%d][%d] * in[%d]", i, j, j);
+			}
+		}
+		fprintf(file, ");\n");
+	}
+	for (int j = 0; j < net->numOutputs; ++j) {
+		fprintf(file, "\tout[%d] = sigmoid(0.0", j);
+		for (int i = 0; i < hid; ++i) {
+			Neuron* n = net->getNeuron(i);
+			if (!n->lesioned && n->getWeight(net->numInputs + j) != 0.0) {
+				fprintf(file, " + outputWeights[%d][%d] * h%d", j, i, i);
+			}
+		}
+		fprintf(file, ");\n");
+	}
+	fprintf(file, "}\n\n}\n\n#endif\n");
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok;
+}
+
+/*!
+ * Write a test harness for an exported Network
+ * The samples are activated with Network::activate and the inputs
+ * and outputs are written to a program that includes the exported
+ * header, runs it on the same inputs and exits with status 1 if any
+ * output differs by more than the tolerance
+ */
+bool exportHarness(Network* net, std::string fname, std::string header, std::string name, const std::vector<std::vector<double> >& samples, double tolerance) {
+	for (unsigned int s = 0; s < samples.size(); ++s) {
+		if ((int)samples[s].size() != net->numInputs) {
+			std::cerr << "Sample " << s << " has " << samples[s].size() << " inputs, expected " << net->numInputs << "; exportHarness" << std::endl;
+			return false;
+		}
+	}
+	FILE* file = fopen(fname.c_str(), "w");
+	if (!file) {
+		std::cerr << "Error - cannot open " << fname << "; exportHarness" << std::endl;
+		return false;
+	}
+	int ns = samples.size();
+	std::vector<double> in, out(net->numOutputs);
+	fprintf(file, "// Test harness for Network %d exported by ESP; do not edit\n", net->getID());
+	fprintf(file, "#include \"%s\"\n#include <cmath>\n#include <cstdio>\n\n", header.c_str());
+	fprintf(file, "static const double inputs[%d][%d] = {\n", ns > 0 ? ns : 1, net->numInputs);
+	for (int s = 0; s < ns; ++s) {
+		fprintf(file, "\t{ ");
+		for (int j = 0; j < net->numInputs; ++j) {
+			fprintf(file, "%.17g, ", samples[s][j]);
+		}
+		fprintf(file, "},\n");
+	}
+	fprintf(file, "};\n\nstatic const double expected[%d][%d] = {\n", ns > 0 ? ns : 1, net->numOutputs);
+	for (int s = 0; s < ns; ++s) {
+		in = samples[s];
+		net->resetActivation();
+		net->activate(in, out);
+		fprintf(file, "\t{ ");
+		for (int j = 0; j < net->numOutputs; ++j) {
+			fprintf(file, "%.17g, ", out[j]);
+		}
+		fprintf(file, "},\n");
+	}
+	fprintf(file, "};\n\n");
+	fprintf(file, "int main() {\n");
+	fprintf(file, "\tdouble out[%s::numOutputs];\n\tdouble err = 0.0;\n", name.c_str());
+	fprintf(file, "\tfor (int s = 0; s < %d; ++s) {\n", ns);
+	fprintf(file, "\t\t%s::activate(inputs[s], out);\n", name.c_str());
+	fprintf(file, "\t\tfor (int j = 0; j < %s::numOutputs; ++j) {\n", name.c_str());
+	fprintf(file, "\t\t\tif (std::fabs(out[j] - expected[s][j]) > err) {\n\t\t\t\terr = std::fabs(out[j] - expected[s][j]);\n\t\t\t}\n\t\t}\n\t}\n");
+	fprintf(file, "\tprintf(\"%s: %d samples, max error %%g\\n\", err);\n", name.c_str(), ns);
+	fprintf(file, "\treturn err > %.17g ? 1 : 0;\n}\n", tolerance);
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok;
+}
+
+}
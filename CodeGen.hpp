@@ -0,0 +1,27 @@
+#ifndef _CODEGEN_HPP_
+#define _CODEGEN_HPP_
+
+#include <string>
+#include <vector>
+
+namespace ESP {
+
+class Network;
+
+/*!
+ * Ahead-of-time export of a trained FeedForwardNetwork
+ * The Network is written as a self-contained C++11 header in which
+ * the weights are constexpr arrays and the forward pass is fully
+ * unrolled. As in QuantizedNetwork, each hidden Neuron holds
+ * numInputs input weights followed by numOutputs output weights and
+ * every unit uses the logistic sigmoid. The harness is a standalone
+ * program that includes the header and checks it against outputs of
+ * Network::activate recorded at export time. Both return false,
+ * without writing anything, if the Network or the samples do not fit
+ */
+bool exportNetwork(Network*, std::string, std::string);
+bool exportHarness(Network*, std::string, std::string, std::string, const std::vector<std::vector<double> >&, double tolerance = 1e-9);
+
+}
+
+#endif
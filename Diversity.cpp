@@ -0,0 +1,200 @@
+#include "Diversity.hpp"
+#include "Neuron.hpp"
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <boost/random.hpp>
+
+namespace ESP {
+
+/*!
+ * Generations between two rebuilds of the sums, which bounds
+ * the rounding error accumulated by remove and insert
+ */
+static const int REBUILD_INTERVAL = 50;
+
+void StagnationCounter::reset() {
+	since = 0;
+	best = -std::numeric_limits<double>::infinity();
+}
+
+void StagnationCounter::update(double fitness) {
+	if (fitness > best) {
+		best = fitness;
+		since = 0;
+	} else {
+		++since;
+	}
+}
+
+DiversityMonitor::DiversityMonitor(NeuronPop& p, int s, double c) : pop(p),
+																	geneSize(0),
+																	count(0),
+																	stalled(s),
+																	collapse(c),
+																	reference(0.0),
+																	generation(0),
+																	bursts(0) {
+	rebuild();
+}
+
+/*!
+ * Recompute the sums from scratch
+ */
+void DiversityMonitor::rebuild() {
+	count = 0;
+	geneSize = pop.getNumIndividuals() ? pop.getIndividual(0)->getSize() : 0;
+	sum.assign(geneSize, 0.0);
+	sumsq.assign(geneSize, 0.0);
+	tracked.clear();
+	snapshot.clear();
+	freeRows.clear();
+	refresh();
+	reference = getDiversity();
+}
+
+/*!
+ * Add k copies of a weight row to the sums, or remove them if k is
+ * negative
+ */
+void DiversityMonitor::add(const double* w, int k) {
+	for (int i = 0; i < geneSize; ++i) {
+		sum[i] += k * w[i];
+		sumsq[i] += k * w[i] * w[i];
+	}
+	count += k;
+}
+
+/*!
+ * Bring the sums up to date with the Population
+ * Neurons whose ID is no longer in the Population are taken out
+ * with the weights they were added with, and Neurons with an ID the
+ * monitor has not seen are added
+ */
+void DiversityMonitor::refresh() {
+	std::map<int, Neuron*> current;
+	std::map<int, int> occurrences;
+	for (unsigned int i = 0; i < pop.getNumIndividuals(); ++i) {
+		Neuron* n = pop.getIndividual(i);
+		if ((int)n->getSize() != geneSize) {
+			std::cerr << "Neuron of size " << n->getSize() << " in subpopulation of size " << geneSize << "; DiversityMonitor::refresh" << std::endl;
+			abort();
+		}
+		current[n->getID()] = n;
+		++occurrences[n->getID()];
+	}
+	std::map<int, Entry>::iterator t = tracked.begin();
+	while (t != tracked.end()) {
+		std::map<int, int>::iterator o = occurrences.find(t->first);
+		int now = o == occurrences.end() ? 0 : o->second;
+		if (now != t->second.count) {
+			add(&snapshot[t->second.row * geneSize], now - t->second.count);
+			t->second.count = now;
+		}
+		if (now == 0) {
+			freeRows.push_back(t->second.row);
+			tracked.erase(t++);
+		} else {
+			++t;
+		}
+	}
+	for (std::map<int, int>::iterator o = occurrences.begin(); o != occurrences.end(); ++o) {
+		if (tracked.count(o->first)) {
+			continue;
+		}
+		Entry e;
+		if (freeRows.empty()) {
+			e.row = snapshot.size() / (geneSize ? geneSize : 1);
+			snapshot.resize(snapshot.size() + geneSize);
+		} else {
+			e.row = freeRows.back();
+			freeRows.pop_back();
+		}
+		e.count = o->second;
+		const double* w = current[o->first]->getWeights();
+		std::copy(w, w + geneSize, snapshot.begin() + e.row * geneSize);
+		add(w, e.count);
+		tracked[o->first] = e;
+	}
+}
+
+/*!
+ * Variance of the weights at a locus
+ */
+double DiversityMonitor::getVariance(int locus) {
+	if (count < 2) {
+		return 0.0;
+	}
+	double mean = sum[locus] / count;
+	return std::max(0.0, sumsq[locus] / count - mean * mean);
+}
+
+/*!
+ * Mean squared distance between two distinct Neurons
+ */
+double DiversityMonitor::getDiversity() {
+	if (count < 2) {
+		return 0.0;
+	}
+	double var = 0.0;
+	for (int i = 0; i < geneSize; ++i) {
+		var += getVariance(i);
+	}
+	return 2.0 * var * count / (count - 1);
+}
+
+/*!
+ * Mean Euclidean distance between random pairs of Neurons
+ */
+double DiversityMonitor::sampleDistance(int samples, boost::mt19937& rng) {
+	int n = pop.getNumIndividuals();
+	if (n < 2 || samples <= 0) {
+		return 0.0;
+	}
+	boost::uniform_int<> dist(0, n - 1);
+	double total = 0.0;
+	for (int s = 0; s < samples; ++s) {
+		int a = dist(rng), b = dist(rng);
+		while (b == a) {
+			b = dist(rng);
+		}
+		const double* x = pop.getIndividual(a)->getWeights();
+		const double* y = pop.getIndividual(b)->getWeights();
+		double d = 0.0;
+		for (int i = 0; i < geneSize; ++i) {
+			d += (x[i] - y[i]) * (x[i] - y[i]);
+		}
+		total += sqrt(d);
+	}
+	return total / samples;
+}
+
+/*!
+ * Per-generation check
+ * Takes the Neuron of the best Network that came from this
+ * subpopulation and the fitness of that Network. Burst mutates the
+ * subpopulation around best and returns true if there was no
+ * improvement for stagnation generations or the diversity fell
+ * below collapse times its reference value
+ */
+bool DiversityMonitor::update(Neuron* best, double fitness, boost::mt19937& rng) {
+	++generation;
+	refresh();
+	stalled.update(fitness);
+	if (generation % REBUILD_INTERVAL == 0) {
+		double ref = reference;
+		rebuild();
+		reference = ref;
+	}
+	if (!stalled.stagnated() && getDiversity() >= collapse * reference) {
+		return false;
+	}
+	pop.deltify(best, rng);
+	rebuild();
+	stalled.reset();
+	++bursts;
+	return true;
+}
+
+}
@@ -0,0 +1,81 @@
+#ifndef _DIVERSITY_HPP_
+#define _DIVERSITY_HPP_
+
+#include "Population.hpp"
+#include <vector>
+#include <map>
+
+namespace ESP {
+
+class Neuron;
+
+/*!
+ * Generations since the best fitness last improved
+ * Starts from minus infinity, so the first fitness counts as an
+ * improvement whatever its sign. Shared by DiversityMonitor and
+ * IncrementalController to decide when to burst mutate
+ */
+class StagnationCounter {
+public:
+	StagnationCounter(int limit) : limit(limit) { reset(); };
+	void update(double);
+	void reset();
+	inline bool stagnated() { return since >= limit; };
+	inline int getGenerations() { return since; };
+private:
+	int limit;					///< Generations without improvement that count as stagnation
+	int since;
+	double best;
+};
+
+/*!
+ * Incremental diversity statistics of a subpopulation
+ * Keeps the per-locus sums and sums of squares of the weights of a
+ * NeuronPop, so the per-locus variance is available at any time.
+ * The mean squared distance between two Neurons equals twice the
+ * summed per-locus variance, so the diversity of the subpopulation
+ * costs O(geneSize) instead of O(n^2 geneSize). The sums follow the
+ * Population by Neuron ID: every change to a Neuron's weights gives
+ * it a new ID, so refresh only has to compare IDs and update the
+ * sums for the Neurons that were added, removed or changed since
+ * the last refresh, whichever operator changed them. Once per
+ * generation update refreshes the sums, checks for stagnation and
+ * diversity collapse and burst mutates the subpopulation with
+ * Population::deltify when either is detected
+ */
+class DiversityMonitor {
+public:
+	DiversityMonitor(NeuronPop&, int stagnation = 20, double collapse = 0.05);
+	void rebuild();
+	void refresh();
+	double getVariance(int);
+	double getDiversity();
+	double sampleDistance(int samples) { return sampleDistance(samples, defaultRng()); };
+	double sampleDistance(int, boost::mt19937&);
+	bool update(Neuron* best, double fitness) { return update(best, fitness, defaultRng()); };
+	bool update(Neuron*, double, boost::mt19937&);
+	inline int getBursts() { return bursts; };
+private:
+	struct Entry {
+		int row;				///< Row of the Neuron's weights in snapshot
+		int count;				///< Number of individuals with this ID
+	};
+	NeuronPop& pop;
+	int geneSize;
+	int count;
+	std::vector<double> sum;
+	std::vector<double> sumsq;
+	std::map<int, Entry> tracked;	///< Neurons in the sums by ID
+	std::vector<double> snapshot;	///< Weights of the tracked Neurons as they were added
+	std::vector<int> freeRows;
+	StagnationCounter stalled;
+	double collapse;			///< Fraction of the reference diversity that counts as collapsed
+	double reference;			///< Diversity right after the last rebuild or burst
+	int generation;
+	int bursts;
+	void add(const double*, int);
+};
+
+}
+
+#endif
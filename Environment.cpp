@@ -1,7 +1,10 @@
 #include "Environment.hpp"
 #include "NeuroEvolution.hpp"
 #include "Network.hpp"
+#include "Novelty.hpp"
 #include <iostream>
+#include <cstdlib>
+#include <algorithm>
 
 namespace ESP {
 
@@ -15,15 +18,38 @@ namespace ESP {
  * Network and is the only function outside of the Network
  * class that can set the value of a Network.  This ensures
  * that Networks are only assigned fitness when they are
- * evaluated.
+ * evaluated.  In novelty search mode the Network is assigned
+ * the novelty of the behavior descriptor reported by evalNet
+ * instead, and the task fitness is still returned.  If the
+ * evaluation was abandoned at a checkpoint the Network is
+ * assigned a fitness below the race cutoff, see checkpoint, and
+ * the partial fitness reported there is returned.
  */
 double Environment::evaluateNetwork(Network* net) {
-	if (netPtr) {
+	if (nePtr) {
 		nePtr->incEvals();
 	}
 	net->resetActivation();
+	pruned = false;
+	objectives.clear();
+	behavior.clear();
 	double fit = evalNet(net);
-	if (nePtr && nePtr->minimize) {
+	if (pruned) {
+		fit = partialFitness;
+		nePtr->incPruned();
+	}
+	if (!objectives.empty()) {
+		net->setObjectives(objectives);
+	}
+	if (nePtr && nePtr->novelty) {
+		if (behavior.empty()) {
+			std::cerr << "Novelty search needs evalNet to fill behavior; Environment::evaluateNetwork" << std::endl;
+			abort();
+		}
+		net->setFitness(nePtr->novelty->evaluate(behavior));
+	} else if (pruned) {
+		net->setFitness(prunedFitness);
+	} else if (nePtr && nePtr->minimize) {
 		net->setFitness(1.0 / (fit + 1.0));
 	} else {
 		net->setFitness(fit);
@@ -31,4 +57,82 @@ double Environment::evaluateNetwork(Network* net) {
 	return fit;
 }
 
+/*!
+ * Evaluate a Network on a given episode
+ * evalNet must derive every random choice of the episode, such as
+ * the initial state and the noise on the inputs, from
+ * getEpisodeSeed, so Networks evaluated with the same seed face
+ * the same episode.  Comparing Networks on common episodes removes
+ * the episode-to-episode variance from their fitness differences.
+ */
+double Environment::evaluateNetwork(Network* net, unsigned int seed) {
+	episodeSeed = seed;
+	seeded = true;
+	double fit = evaluateNetwork(net);
+	seeded = false;
+	return fit;
+}
+
+/*!
+ * Evaluate a Network on the common episodes of the generation
+ * The episodes are those drawn by NeuroEvolution::newEpisodeSeeds,
+ * so all the Environments given the same NeuroEvolution with
+ * setNetPtr evaluate every Network on the same episodes. Returns
+ * the mean fitness over the episodes. Without a NeuroEvolution or
+ * common episodes the Network is evaluated once on a fresh episode
+ */
+double Environment::evaluateEpisodes(Network* net) {
+	if (!nePtr) {
+		return evaluateNetwork(net);
+	}
+	return evaluateEpisodes(net, nePtr->episodeSeeds);
+}
+
+/*!
+ * Evaluate a Network on the given episodes
+ * Same as above for callers that draw their own episodes. wasPruned
+ * then tells whether any of the episodes was abandoned
+ */
+double Environment::evaluateEpisodes(Network* net, const std::vector<unsigned int>& seeds) {
+	if (seeds.empty()) {
+		return evaluateNetwork(net);
+	}
+	double fit = 0.0;
+	bool any = false;
+	for (unsigned int i = 0; i < seeds.size(); ++i) {
+		fit += evaluateNetwork(net, seeds[i]);
+		any = any || pruned;
+	}
+	pruned = any;
+	return fit / seeds.size();
+}
+
+/*!
+ * Report the progress of the running episode
+ * Called by evalNet at checkpoints with the fitness accumulated so
+ * far and the best final fitness the episode can still reach.  When
+ * racing, returns false if that bound cannot beat the current race
+ * cutoff, in which case evalNet should stop the episode and return.
+ * The Network is then assigned the lower of the bound and the
+ * partial fitness, both on the selection scale, which keeps it
+ * ranked below the cutoff and so below every Network that could
+ * still breed.  When minimizing, the partial cost is below the
+ * bound on the final cost, so its transformed fitness alone would
+ * rank the Network above the cutoff.
+ */
+bool Environment::checkpoint(double partial, double best) {
+	partialFitness = partial;
+	if (!nePtr || !nePtr->racing || nePtr->novelty) {
+		return true;
+	}
+	double bound = nePtr->minimize ? 1.0 / (best + 1.0) : best;
+	if (bound < nePtr->raceCutoff) {
+		double scaled = nePtr->minimize ? 1.0 / (partial + 1.0) : partial;
+		prunedFitness = std::min(bound, scaled);
+		pruned = true;
+		return false;
+	}
+	return true;
+}
+
 }
\ No newline at end of file
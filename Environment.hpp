@@ -13,14 +13,28 @@ class NeuroEvolution;
 /*!
  * Virtual class that describes the interface
  * for all task environments used in NeuroEvolution objects
+ * An evaluation keeps its state in the Environment (episode seed,
+ * racing checkpoint, objectives and behavior), so one Environment
+ * must not evaluate two Networks concurrently; parallel evaluation
+ * gives each thread its own Environment, all sharing the
+ * NeuroEvolution through setNetPtr
  */
 class Environment {
 public:
-	Environment() : nePtr(0), tolerance(0), incremental(false) {};
+	Environment() : nePtr(0), tolerance(0), incremental(false), pruned(false), partialFitness(0.0), prunedFitness(0.0), episodeSeed(0), seeded(false) {};
 	virtual ~Environment() {};
 	double evaluateNetwork(Network*);
+	double evaluateNetwork(Network*, unsigned int);
+	double evaluateEpisodes(Network*);
+	double evaluateEpisodes(Network*, const std::vector<unsigned int>&);
 	virtual void nextTask() {};
 	virtual void simplifyTask() {};
+	/*!
+	 * Whether the current task is the goal task
+	 * Incremental Environments override this to report when
+	 * nextTask has reached the last task of the sequence
+	 */
+	virtual bool finalTask() { return !incremental; };
 	virtual double evalNetDump(Network *net, FILE*) { return 0.0; };
 	virtual double generalizationTest(Network*) { return 0.0; };
 	void setNetPtr(NeuroEvolution* e) { nePtr = e; };
@@ -29,6 +43,9 @@ public:
 	inline double getTolerance() { return tolerance; };
 	inline bool getIncremental() { return incremental; };
 	inline std::string getName() { return name; };
+	inline bool wasPruned() { return pruned; };
+	inline bool hasEpisodeSeed() { return seeded; };
+	inline unsigned int getEpisodeSeed() { return episodeSeed; };
 protected:
 	NeuroEvolution* nePtr; 		///< Pointer to the NeuroEvolution algorithm
 	std::string name;
@@ -36,6 +53,14 @@ protected:
 	bool incremental;
 	int inputDimension;			///< Dimension of input space
 	int outputDimension;		///< Dimension of output space
+	std::vector<double> objectives;	///< Objective values of the last evaluation, filled by evalNet for multi-objective selection
+	std::vector<double> behavior;	///< Behavior descriptor of the last evaluation, filled by evalNet for novelty search
+	bool pruned;				///< Whether the last evaluation was abandoned by racing
+	double partialFitness;		///< Fitness reported at the last checkpoint
+	double prunedFitness;		///< Selection fitness of the last pruned Network, below the race cutoff
+	unsigned int episodeSeed;	///< Seed of the episode being evaluated, valid while seeded
+	bool seeded;				///< Whether evalNet must generate its episode from episodeSeed
+	bool checkpoint(double, double);
 	virtual void setupInput(std::vector<double>& input) = 0;
 	virtual double evalNet(Network* net) = 0;
 };
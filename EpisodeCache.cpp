@@ -0,0 +1,49 @@
+#include <algorithm>
+
+namespace ESP {
+
+template <typename S>
+EpisodeCache<S>::EpisodeCache(Generator g) : generate(g), hits(0), misses(0) {
+}
+
+/*!
+ * Get the episode of a seed, generating it on first use
+ */
+template <typename S>
+const S& EpisodeCache<S>::get(unsigned int seed) {
+	boost::mutex::scoped_lock lock(mutex);
+	typename std::map<unsigned int, S>::iterator it = episodes.find(seed);
+	if (it != episodes.end()) {
+		++hits;
+		return it->second;
+	}
+	++misses;
+	S& episode = episodes[seed];
+	generate(seed, episode);
+	return episode;
+}
+
+/*!
+ * Drop every episode whose seed is not in seeds
+ * Called when the engine draws the episodes of a new generation
+ */
+template <typename S>
+void EpisodeCache<S>::retain(const std::vector<unsigned int>& seeds) {
+	boost::mutex::scoped_lock lock(mutex);
+	typename std::map<unsigned int, S>::iterator it = episodes.begin();
+	while (it != episodes.end()) {
+		if (std::find(seeds.begin(), seeds.end(), it->first) == seeds.end()) {
+			episodes.erase(it++);
+		} else {
+			++it;
+		}
+	}
+}
+
+template <typename S>
+void EpisodeCache<S>::clear() {
+	boost::mutex::scoped_lock lock(mutex);
+	episodes.clear();
+}
+
+}
@@ -0,0 +1,39 @@
+#ifndef _EPISODECACHE_HPP_
+#define _EPISODECACHE_HPP_
+
+#include <map>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+
+namespace ESP {
+
+/*!
+ * Cache of generated episodes keyed by episode seed
+ * S holds whatever an Environment needs to replay an episode, such
+ * as its initial state and input sequence. The first request for a
+ * seed generates the episode, later requests from any thread share
+ * it. References stay valid until the episode is dropped by retain
+ * or clear
+ */
+template <typename S>
+class EpisodeCache {
+public:
+	typedef void (*Generator)(unsigned int, S&);
+	EpisodeCache(Generator);
+	const S& get(unsigned int);
+	void retain(const std::vector<unsigned int>&);
+	void clear();
+	inline int getHits() { return hits; };
+	inline int getMisses() { return misses; };
+private:
+	std::map<unsigned int, S> episodes;
+	Generator generate;
+	boost::mutex mutex;
+	int hits;
+	int misses;
+};
+
+}
+
+#include "EpisodeCache.cpp"
+#endif
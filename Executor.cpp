@@ -0,0 +1,216 @@
+#include "Executor.hpp"
+#include <boost/bind/bind.hpp>
+#include <boost/thread/tss.hpp>
+
+namespace ESP {
+
+/*!
+ * Executor and worker index of the calling thread
+ */
+static boost::thread_specific_ptr<std::pair<Executor*, int> > workerIndex;
+
+Executor::Executor(int n, boost::function<void()> init) : pending(0), submitted(0), stop(false) {
+	if (n <= 0) {
+		n = std::max(1u, boost::thread::hardware_concurrency());
+	}
+	for (int i = 0; i < n; ++i) {
+		workers.push_back(new Worker);
+	}
+	for (int i = 0; i < n; ++i) {
+		threads.create_thread(boost::bind(&Executor::work, this, i, init));
+	}
+}
+
+Executor::~Executor() {
+	wait();
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		stop = true;
+	}
+	taskReady.notify_all();
+	threads.join_all();
+	for (unsigned int i = 0; i < workers.size(); ++i) {
+		delete workers[i];
+	}
+}
+
+/*!
+ * Worker index of the calling thread, -1 outside any executor
+ */
+int Executor::currentWorker() {
+	std::pair<Executor*, int>* i = workerIndex.get();
+	return i ? i->second : -1;
+}
+
+/*!
+ * Whether the calling thread is one of this executor's workers
+ */
+bool Executor::isWorker() {
+	std::pair<Executor*, int>* i = workerIndex.get();
+	return i && i->first == this;
+}
+
+/*!
+ * Submit a task
+ * From one of this executor's workers the task goes to that
+ * worker's deque, otherwise to the shared queue. The task is
+ * counted in pending before another worker can steal it, so pending
+ * cannot drop to zero, and wait return, while it is still queued
+ */
+void Executor::submit(boost::function<void()> task) {
+	int w = isWorker() ? currentWorker() : -1;
+	if (w < 0) {
+		submitShared(task);
+		return;
+	}
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		boost::mutex::scoped_lock workerLock(workers[w]->mutex);
+		workers[w]->tasks.push_back(task);
+		++pending;
+		++submitted;
+	}
+	taskReady.notify_one();
+}
+
+void Executor::submitShared(boost::function<void()> task) {
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		shared.push_back(task);
+		++pending;
+		++submitted;
+	}
+	taskReady.notify_one();
+}
+
+/*!
+ * Find the next task for worker w
+ * Own deque from the back, then the shared queue, then the front
+ * of the other workers' deques. Helpers waiting in runAll skip the
+ * shared queue so they do not pick up unrelated jobs
+ */
+bool Executor::next(int w, boost::function<void()>& task, bool useShared) {
+	if (w >= 0) {
+		boost::mutex::scoped_lock lock(workers[w]->mutex);
+		if (!workers[w]->tasks.empty()) {
+			task = workers[w]->tasks.back();
+			workers[w]->tasks.pop_back();
+			return true;
+		}
+	}
+	if (useShared) {
+		boost::mutex::scoped_lock lock(mutex);
+		if (!shared.empty()) {
+			task = shared.front();
+			shared.pop_front();
+			return true;
+		}
+	}
+	int n = workers.size();
+	for (int k = 1; k <= n; ++k) {
+		int v = (w + k + n) % n;
+		if (v == w) {
+			continue;
+		}
+		boost::mutex::scoped_lock lock(workers[v]->mutex);
+		if (!workers[v]->tasks.empty()) {
+			task = workers[v]->tasks.front();
+			workers[v]->tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void Executor::finish() {
+	boost::mutex::scoped_lock lock(mutex);
+	if (--pending == 0) {
+		allDone.notify_all();
+	}
+	taskReady.notify_all();
+}
+
+/*!
+ * Worker loop
+ * A task is always queued before submitted is incremented, so a
+ * worker that found nothing and sees submitted unchanged since it
+ * started looking can sleep until the next submission without
+ * missing a task
+ */
+void Executor::work(int w, boost::function<void()> init) {
+	workerIndex.reset(new std::pair<Executor*, int>(this, w));
+	if (init) {
+		init();
+	}
+	boost::function<void()> task;
+	for (;;) {
+		unsigned int seen;
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			seen = submitted;
+		}
+		if (next(w, task, true)) {
+			task();
+			task.clear();
+			finish();
+			continue;
+		}
+		boost::mutex::scoped_lock lock(mutex);
+		while (submitted == seen && !(stop && pending == 0)) {
+			taskReady.wait(lock);
+		}
+		if (stop && pending == 0) {
+			return;
+		}
+	}
+}
+
+/*!
+ * Run one task of a runAll and count it as done
+ * finish, which follows every task, wakes the runAll caller
+ */
+void Executor::runCounted(boost::function<void()> task, int* remaining) {
+	task();
+	boost::mutex::scoped_lock lock(mutex);
+	--*remaining;
+}
+
+/*!
+ * Run a set of tasks and return once all of them have finished
+ * The calling thread runs tasks while it waits, so runAll can be
+ * called from inside a task without tying up a worker. When there
+ * is nothing left to take it sleeps until another task finishes
+ */
+void Executor::runAll(std::vector<boost::function<void()> >& tasks) {
+	int remaining = tasks.size();
+	for (unsigned int i = 0; i < tasks.size(); ++i) {
+		submit(boost::bind(&Executor::runCounted, this, tasks[i], &remaining));
+	}
+	int w = isWorker() ? currentWorker() : -1;
+	boost::function<void()> task;
+	for (;;) {
+		if (next(w, task, false)) {
+			task();
+			task.clear();
+			finish();
+			continue;
+		}
+		boost::mutex::scoped_lock lock(mutex);
+		if (remaining == 0) {
+			return;
+		}
+		taskReady.wait(lock);
+	}
+}
+
+/*!
+ * Block until every submitted task has finished
+ */
+void Executor::wait() {
+	boost::mutex::scoped_lock lock(mutex);
+	while (pending > 0) {
+		allDone.wait(lock);
+	}
+}
+
+}
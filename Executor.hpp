@@ -0,0 +1,59 @@
+#ifndef _EXECUTOR_HPP_
+#define _EXECUTOR_HPP_
+
+#include <deque>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace ESP {
+
+/*!
+ * Work-stealing executor
+ * Every worker has its own deque of tasks. Tasks submitted by a
+ * worker go to the back of its deque and are run last in, first out;
+ * idle workers steal from the front of the other deques. Tasks
+ * submitted from outside, or with submitShared, go to a shared queue
+ * that is served first in, first out, which is how independent jobs
+ * such as the generations of different runs are kept fair. A task
+ * can fan out work with runAll, whose caller helps with the pending
+ * tasks instead of blocking a worker. Each worker can be given an
+ * initialization task, run once before any other task, which is
+ * used to pin workers to CPUs or NUMA nodes
+ */
+class Executor {
+public:
+	Executor(int threads = 0, boost::function<void()> init = boost::function<void()>());
+	~Executor();
+	void submit(boost::function<void()>);
+	void submitShared(boost::function<void()>);
+	void runAll(std::vector<boost::function<void()> >&);
+	void wait();
+	inline int getNumThreads() { return workers.size(); };
+	static int currentWorker();
+	bool isWorker();
+private:
+	struct Worker {
+		std::deque<boost::function<void()> > tasks;
+		boost::mutex mutex;
+	};
+	std::vector<Worker*> workers;
+	std::deque<boost::function<void()> > shared;
+	boost::mutex mutex;			///< Guards shared, pending, stop, runAll counters and the condition variables; taken before a Worker mutex
+	boost::condition_variable taskReady;
+	boost::condition_variable allDone;
+	int pending;
+	unsigned int submitted;		///< Count of submitted tasks, lets idle workers tell whether anything arrived while they searched
+	bool stop;
+	boost::thread_group threads;
+	bool next(int, boost::function<void()>&, bool);
+	void finish();
+	void work(int, boost::function<void()>);
+	void runCounted(boost::function<void()>, int*);
+};
+
+}
+
+#endif
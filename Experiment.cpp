@@ -0,0 +1,35 @@
+#include "Experiment.hpp"
+#include <boost/bind/bind.hpp>
+
+namespace ESP {
+
+ExperimentRunner::ExperimentRunner(int threads) : executor(threads) {
+}
+
+void ExperimentRunner::add(Run* r) {
+	r->executor = &executor;
+	runs.push_back(r);
+}
+
+/*!
+ * Run one generation and queue the next one behind the other runs
+ */
+void ExperimentRunner::step(Run* r) {
+	bool more = r->generation();
+	++r->generations;
+	if (more) {
+		executor.submitShared(boost::bind(&ExperimentRunner::step, this, r));
+	}
+}
+
+/*!
+ * Run every added run to completion
+ */
+void ExperimentRunner::run() {
+	for (unsigned int i = 0; i < runs.size(); ++i) {
+		executor.submitShared(boost::bind(&ExperimentRunner::step, this, runs[i]));
+	}
+	executor.wait();
+}
+
+}
@@ -0,0 +1,82 @@
+#ifndef _EXPERIMENT_HPP_
+#define _EXPERIMENT_HPP_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include "Executor.hpp"
+
+namespace ESP {
+
+/*!
+ * A single evolutionary run
+ * Subclasses own their NeuroEvolution and Environment, seed them
+ * from seed and write only to their own results stream, so runs
+ * sharing one ExperimentRunner do not interfere. rng is the only
+ * random stream of a run: its NeuroEvolution is constructed with
+ * &rng, and the random operators (create, mutate, perturb, deltify,
+ * selectRndIndividual, DiversityMonitor::update) are given rng.
+ * Their versions without a generator use the worker thread's
+ * stream, which every run scheduled on that worker shares, so a run
+ * using them is no longer reproducible from its seed. Random choices
+ * must stay in generation itself; the evaluations a generation
+ * spreads over the executor with runAll must not draw from rng
+ */
+class Run {
+public:
+	unsigned int seed;			///< Seed of the run's random stream
+	std::ostream& results;		///< Where the run writes its results
+	Executor* executor;			///< Executor the run is scheduled on, set by the runner
+	int generations;			///< The number of generations completed
+	boost::mt19937 rng;			///< Random stream of the run, seeded from seed
+	Run(unsigned int s, std::ostream& out) : seed(s), results(out), executor(0), generations(0), rng(s) {};
+	virtual ~Run() {};
+	virtual bool generation() = 0;	///< Run one generation, false once the run has finished
+};
+
+/*!
+ * Runs several experiments concurrently on one Executor
+ * Each run is scheduled one generation at a time through the
+ * executor's shared queue, so every run advances in turn and no
+ * run can monopolize the workers. Large immutable task data can be
+ * built once and shared between runs with share
+ */
+class ExperimentRunner {
+public:
+	ExperimentRunner(int threads = 0);
+	void add(Run*);
+	void run();
+	Executor& getExecutor() { return executor; };
+	template <typename T> boost::shared_ptr<const T> share(const std::string&, T* (*)());
+private:
+	Executor executor;
+	std::vector<Run*> runs;
+	std::map<std::string, boost::shared_ptr<const void> > data;	///< Shared immutable data by key
+	boost::mutex dataMutex;
+	void step(Run*);
+};
+
+/*!
+ * Get the shared data stored under key
+ * The data is built with make the first time it is requested and
+ * handed out read only afterwards
+ */
+template <typename T>
+boost::shared_ptr<const T> ExperimentRunner::share(const std::string& key, T* (*make)()) {
+	boost::mutex::scoped_lock lock(dataMutex);
+	std::map<std::string, boost::shared_ptr<const void> >::iterator it = data.find(key);
+	if (it == data.end()) {
+		boost::shared_ptr<const T> p(make());
+		data[key] = p;
+		return p;
+	}
+	return boost::static_pointer_cast<const T>(it->second);
+}
+
+}
+
+#endif
@@ -0,0 +1,152 @@
+#include "FeedForward.hpp"
+#include "Neuron.hpp"
+#include <iostream>
+#include <algorithm>
+
+namespace ESP {
+
+const TypeDescriptor FeedForwardNetwork::descriptor = { "feed forward", 100 };
+static RegisterType registerFeedForwardNetwork(FeedForwardNetwork::descriptor);
+
+FeedForwardNetwork::FeedForwardNetwork(int in, int hid, int out) : Network(in, hid, out) {
+	geneSize = in + out;
+}
+
+Network* FeedForwardNetwork::newNetwork(int in, int hid, int out) {
+	return new FeedForwardNetwork(in, hid, out);
+}
+
+Network* FeedForwardNetwork::clone() {
+	return new FeedForwardNetwork(numInputs, hiddenUnits.size(), numOutputs);
+}
+
+void FeedForwardNetwork::addNeuron() {
+	Neuron* n = new Neuron(geneSize);
+	n->create();
+	hiddenUnits.push_back(n);
+	activation.push_back(0.0);
+}
+
+void FeedForwardNetwork::removeNeuron(int i) {
+	if (i < 0 || i >= (int)hiddenUnits.size() || (int)hiddenUnits.size() <= getMinUnits()) {
+		std::cerr << "Cannot remove Neuron " << i << "; FeedForwardNetwork::removeNeuron" << std::endl;
+		return;
+	}
+	if (created) {
+		delete hiddenUnits[i];
+	}
+	hiddenUnits.erase(hiddenUnits.begin() + i);
+	activation.erase(activation.begin() + i);
+}
+
+/*!
+ * Activate the Network on a single input
+ */
+void FeedForwardNetwork::activate(std::vector<double>& input, std::vector<double>& output) {
+	pack();
+	output.assign(numOutputs, 0.0);
+	for (unsigned int i = 0; i < hiddenUnits.size(); ++i) {
+		if (hiddenUnits[i]->lesioned) {
+			activation[i] = 0.0;
+			continue;
+		}
+		const double* w = &inWeights[i * numInputs];
+		double sum = 0.0;
+		for (int j = 0; j < numInputs; ++j) {
+			sum += w[j] * input[j];
+		}
+		activation[i] = sigmoid(sum);
+		w = &outWeights[i * numOutputs];
+		for (int j = 0; j < numOutputs; ++j) {
+			output[j] += activation[i] * w[j];
+		}
+	}
+	for (int j = 0; j < numOutputs; ++j) {
+		output[j] = sigmoid(output[j]);
+	}
+}
+
+/*!
+ * Copy the weights of the Neurons into the input and output blocks
+ * Lesioned Neurons get zero output weights. Does nothing if the
+ * blocks already hold the current weights
+ */
+void FeedForwardNetwork::pack() {
+	int hid = hiddenUnits.size();
+	bool current = (int)packedIDs.size() == hid;
+	for (int i = 0; i < hid && current; ++i) {
+		current = packedIDs[i] == (hiddenUnits[i]->lesioned ? -hiddenUnits[i]->getID() : hiddenUnits[i]->getID());
+	}
+	if (current) {
+		return;
+	}
+	packedIDs.resize(hid);
+	inWeights.resize(hid * numInputs);
+	outWeights.resize(hid * numOutputs);
+	for (int i = 0; i < hid; ++i) {
+		Neuron* n = hiddenUnits[i];
+		if ((int)n->getSize() != geneSize || !n->isDense()) {
+			std::cerr << "Neuron " << i << " is not a dense Neuron of size " << geneSize << "; FeedForwardNetwork::pack" << std::endl;
+			abort();
+		}
+		const double* w = n->getWeights();
+		std::copy(w, w + numInputs, inWeights.begin() + i * numInputs);
+		if (n->lesioned) {
+			std::fill(outWeights.begin() + i * numOutputs, outWeights.begin() + (i + 1) * numOutputs, 0.0);
+		} else {
+			std::copy(w + numInputs, w + geneSize, outWeights.begin() + i * numOutputs);
+		}
+		packedIDs[i] = n->lesioned ? -n->getID() : n->getID();
+	}
+}
+
+/*!
+ * Pack the weights into blocks allocated by the calling thread
+ * First-touch places the blocks on the caller's NUMA node, and
+ * repacking later reuses them, so a Network that is always
+ * evaluated on one node reads only that node's memory
+ */
+void FeedForwardNetwork::rehome() {
+	pack();
+	std::vector<double>(inWeights).swap(inWeights);
+	std::vector<double>(outWeights).swap(outWeights);
+}
+
+/*!
+ * Activate the Network on a batch of inputs stored row-major
+ * The Network has no recurrent state, so the lanes are independent
+ * and only the packed weights are shared between them
+ */
+void FeedForwardNetwork::activateBatch(std::vector<double>& inputs, std::vector<double>& outputs, int batch) {
+	pack();
+	int hid = hiddenUnits.size();
+	hidden.resize(hid * batch);
+	outputs.assign(batch * numOutputs, 0.0);
+	for (int i = 0; i < hid; ++i) {
+		const double* w = &inWeights[i * numInputs];
+		double* h = &hidden[i * batch];
+		for (int b = 0; b < batch; ++b) {
+			const double* in = &inputs[b * numInputs];
+			double sum = 0.0;
+			for (int j = 0; j < numInputs; ++j) {
+				sum += w[j] * in[j];
+			}
+			h[b] = sigmoid(sum);
+		}
+	}
+	for (int i = 0; i < hid; ++i) {
+		const double* w = &outWeights[i * numOutputs];
+		const double* h = &hidden[i * batch];
+		for (int b = 0; b < batch; ++b) {
+			double* out = &outputs[b * numOutputs];
+			for (int j = 0; j < numOutputs; ++j) {
+				out[j] += h[b] * w[j];
+			}
+		}
+	}
+	for (int k = 0; k < batch * numOutputs; ++k) {
+		outputs[k] = sigmoid(outputs[k]);
+	}
+}
+
+}
@@ -0,0 +1,49 @@
+#ifndef _FEEDFORWARD_HPP_
+#define _FEEDFORWARD_HPP_
+
+#include "Network.hpp"
+#include <vector>
+
+namespace ESP {
+
+class Neuron;
+
+/*!
+ * Dense feed-forward Network
+ * Each hidden Neuron holds numInputs weights from the inputs
+ * followed by numOutputs weights to the outputs. Batched activation
+ * packs the weights into one input block and one output block and
+ * computes every lane against each weight row while the row is in
+ * cache, instead of walking the Neurons once per lane. The blocks
+ * are kept between calls and repacked only when a Neuron was
+ * replaced, changed its weights or was lesioned; every weight change
+ * gives a Neuron a new ID, so comparing IDs is enough. Single
+ * activation reads the same blocks, so once rehome has placed them
+ * on a NUMA node the Network never reads its Neurons' weights from
+ * their subpopulations' nodes
+ */
+class FeedForwardNetwork : public Network {
+public:
+	static const TypeDescriptor descriptor;
+	FeedForwardNetwork(int, int, int);
+	virtual Network* newNetwork(int, int, int);
+	virtual Network* clone();
+	virtual const TypeDescriptor& getDescriptor() { return descriptor; };
+	virtual void growNeuron(Neuron*) {};
+	virtual void shrinkNeuron(Neuron*, int) {};
+	virtual void addNeuron();
+	virtual void removeNeuron(int);
+	virtual void activate(std::vector<double>&, std::vector<double>&);
+	virtual void activateBatch(std::vector<double>&, std::vector<double>&, int);
+	virtual void rehome();
+protected:
+	std::vector<double> inWeights;	///< Input weights, one row of numInputs per hidden Neuron
+	std::vector<double> outWeights;	///< Output weights, one row of numOutputs per hidden Neuron
+	std::vector<double> hidden;		///< Hidden activations of a batch, one row per hidden Neuron
+	std::vector<int> packedIDs;		///< IDs of the Neurons the blocks hold, negated for lesioned Neurons
+	void pack();
+};
+
+}
+
+#endif
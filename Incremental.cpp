@@ -0,0 +1,124 @@
+#include "Incremental.hpp"
+#include "Environment.hpp"
+#include "Network.hpp"
+#include "Neuron.hpp"
+#include <iostream>
+#include <boost/bind/bind.hpp>
+
+namespace ESP {
+
+/*!
+ * The generalization tests run on test if given, otherwise on the
+ * evolution Environment, in which case its generalizationTest must
+ * be safe to call while other Networks are being evaluated
+ */
+IncrementalController::IncrementalController(Environment& e, int s, Environment* test) : envt(e),
+																						 testEnvt(test ? test : &e),
+																						 stalled(s),
+																						 task(0),
+																						 tester(0),
+																						 testing(false),
+																						 candidate(0),
+																						 solution(0) {
+}
+
+IncrementalController::~IncrementalController() {
+	if (tester) {
+		tester->join();
+		delete tester;
+	}
+	delete candidate;
+	delete solution;
+}
+
+/*!
+ * Update the controller with the best Network of a generation
+ * Must be called after the subpopulations have been evaluated.
+ * The task is made harder until Environment::finalTask reports the
+ * goal task, after which solutions are generalization tested. The
+ * task is never made easier than the initial task
+ */
+void IncrementalController::update(Network* best, std::vector<NeuronPop*>& subpops, boost::mt19937& rng) {
+	double fit = best->getFitness();
+	stalled.update(fit);
+	if (fit >= envt.getTolerance()) {
+		if (!envt.finalTask()) {
+			envt.nextTask();
+			++task;
+			stalled.reset();
+		} else {
+			startTest(best);
+		}
+	} else if (stalled.stagnated()) {
+		if (envt.getIncremental() && task > 0) {
+			envt.simplifyTask();
+			--task;
+		}
+		burstMutate(best, subpops, rng);
+		stalled.reset();
+	}
+}
+
+/*!
+ * Delta coding burst mutation
+ * Each subpopulation becomes a neighbourhood of the Neuron the best
+ * Network took from it
+ */
+void IncrementalController::burstMutate(Network* best, std::vector<NeuronPop*>& subpops, boost::mt19937& rng) {
+	if ((int)subpops.size() != best->getNumNeurons()) {
+		std::cerr << "Number of subpopulations does not match the Network; IncrementalController::burstMutate" << std::endl;
+		abort();
+	}
+	for (unsigned int i = 0; i < subpops.size(); ++i) {
+		subpops[i]->deltify(best->getNeuron(i), rng);
+	}
+}
+
+/*!
+ * Start a generalization test of a copy of the Network
+ * Does nothing if a test is still running or the task is solved
+ */
+void IncrementalController::startTest(Network* net) {
+	boost::mutex::scoped_lock lock(mutex);
+	if (testing || solution) {
+		return;
+	}
+	if (tester) {
+		tester->join();
+		delete tester;
+	}
+	delete candidate;
+	candidate = net->clone();
+	*candidate = *net;
+	testing = true;
+	tester = new boost::thread(boost::bind(&IncrementalController::runTest, this));
+}
+
+void IncrementalController::runTest() {
+	double result = testEnvt->generalizationTest(candidate);
+	boost::mutex::scoped_lock lock(mutex);
+	if (result >= testEnvt->getTolerance()) {
+		solution = candidate;
+		candidate = 0;
+	}
+	testing = false;
+}
+
+/*!
+ * Whether a Network has passed the generalization test
+ */
+bool IncrementalController::solved() {
+	boost::mutex::scoped_lock lock(mutex);
+	return solution != 0;
+}
+
+/*!
+ * The Network that passed the generalization test, 0 if none has
+ * The controller keeps ownership of the Network
+ */
+Network* IncrementalController::getSolution() {
+	boost::mutex::scoped_lock lock(mutex);
+	return solution;
+}
+
+}
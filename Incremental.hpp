@@ -0,0 +1,52 @@
+#ifndef _INCREMENTAL_HPP_
+#define _INCREMENTAL_HPP_
+
+#include "Population.hpp"
+#include "Diversity.hpp"
+#include <vector>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace ESP {
+
+class Environment;
+class Network;
+
+/*!
+ * Incremental evolution controller
+ * Drives an incremental Environment through its sequence of tasks.
+ * Called once per generation with the best Network: when the best
+ * Network reaches the tolerance the task is made harder, and when
+ * evolution stagnates the task is made easier and the subpopulations
+ * are burst mutated around the best Network. Once the final task is
+ * reached the best Networks are generalization tested on a background
+ * thread so evolution does not wait for the tests
+ */
+class IncrementalController {
+public:
+	IncrementalController(Environment&, int stagnation = 20, Environment* test = 0);
+	~IncrementalController();
+	void update(Network* best, std::vector<NeuronPop*>& subpops) { update(best, subpops, defaultRng()); };
+	void update(Network*, std::vector<NeuronPop*>&, boost::mt19937&);
+	bool solved();
+	Network* getSolution();
+	inline int getTask() { return task; };
+	inline int getStagnation() { return stalled.getGenerations(); };
+private:
+	Environment& envt;
+	Environment* testEnvt;		///< Environment used for generalization tests
+	StagnationCounter stalled;	///< Generations without improvement, bursts when stagnated
+	int task;					///< Current task, relative to the initial task, never negative
+	boost::thread* tester;
+	boost::mutex mutex;
+	bool testing;
+	Network* candidate;			///< Copy of the Network being tested
+	Network* solution;			///< First Network that passed the generalization test
+	void burstMutate(Network*, std::vector<NeuronPop*>&, boost::mt19937&);
+	void startTest(Network*);
+	void runTest();
+};
+
+}
+
+#endif
@@ -0,0 +1,217 @@
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <cstdlib>
+
+namespace ESP {
+
+/*!
+ * Objective matrix of a set of individuals
+ * Copies the objectives into a row-major N x M matrix so the
+ * dominance tests do not go through the individuals. Individuals
+ * without objectives, such as Neurons that took part in no
+ * evaluation this generation, are marked as unevaluated and get a
+ * row of zeros that is never compared
+ */
+template <typename T>
+static int objectiveMatrix(std::vector<T*>& ind, std::vector<double>& obj, std::vector<char>& evaluated) {
+	int m = 0;
+	for (unsigned int i = 0; i < ind.size() && m == 0; ++i) {
+		m = ind[i]->getNumObjectives();
+	}
+	obj.assign(ind.size() * m, 0.0);
+	evaluated.assign(ind.size(), 0);
+	for (unsigned int i = 0; i < ind.size(); ++i) {
+		int k = ind[i]->getNumObjectives();
+		if (k == 0) {
+			continue;
+		}
+		if (k != m) {
+			std::cerr << "Individuals with different numbers of objectives; objectiveMatrix" << std::endl;
+			abort();
+		}
+		evaluated[i] = 1;
+		for (int j = 0; j < m; ++j) {
+			obj[i * m + j] = ind[i]->getObjective(j);
+		}
+	}
+	return m;
+}
+
+/*!
+ * Whether a dominates b, all objectives maximized
+ */
+static inline bool dominates(const double* a, const double* b, int m) {
+	bool better = false;
+	for (int j = 0; j < m; ++j) {
+		if (a[j] < b[j]) {
+			return false;
+		}
+		better = better || a[j] > b[j];
+	}
+	return better;
+}
+
+/*!
+ * Lexicographic order, best first
+ */
+struct LexicographicOrder {
+	const double* obj;
+	int m;
+	bool operator()(int a, int b) const {
+		for (int j = 0; j < m; ++j) {
+			if (obj[a * m + j] != obj[b * m + j]) {
+				return obj[a * m + j] > obj[b * m + j];
+			}
+		}
+		return a < b;
+	}
+};
+
+/*!
+ * Whether any member of a front dominates p
+ * The front is scanned from its last member, the most likely to
+ * dominate p
+ */
+static bool frontDominates(const std::vector<int>& front, const double* obj, int m, int p) {
+	for (int i = front.size() - 1; i >= 0; --i) {
+		if (dominates(obj + front[i] * m, obj + p * m, m)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*!
+ * Non-dominated front of each individual, 0 for the first front
+ * Unevaluated individuals are put in a front of their own after
+ * all the others
+ */
+template <typename T>
+void nondominatedSort(std::vector<T*>& ind, std::vector<int>& rank) {
+	std::vector<double> obj;
+	std::vector<char> evaluated;
+	int m = objectiveMatrix(ind, obj, evaluated);
+	int n = ind.size();
+	rank.assign(n, 0);
+	if (n == 0 || m == 0) {
+		return;
+	}
+	std::vector<int> order;
+	for (int i = 0; i < n; ++i) {
+		if (evaluated[i]) {
+			order.push_back(i);
+		}
+	}
+	LexicographicOrder cmp = { &obj[0], m };
+	std::sort(order.begin(), order.end(), cmp);
+	std::vector<std::vector<int> > fronts;
+	for (unsigned int k = 0; k < order.size(); ++k) {
+		int p = order[k];
+		int lo = 0, hi = fronts.size();
+		while (lo < hi) {
+			int mid = (lo + hi) / 2;
+			if (frontDominates(fronts[mid], &obj[0], m, p)) {
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
+		}
+		if (lo == (int)fronts.size()) {
+			fronts.push_back(std::vector<int>());
+		}
+		fronts[lo].push_back(p);
+		rank[p] = lo;
+	}
+	for (int i = 0; i < n; ++i) {
+		if (!evaluated[i]) {
+			rank[i] = fronts.size();
+		}
+	}
+}
+
+struct ObjectiveOrder {
+	const double* obj;
+	int m;
+	int j;
+	bool operator()(int a, int b) const { return obj[a * m + j] < obj[b * m + j]; }
+};
+
+/*!
+ * Crowding distance of each individual within its front
+ * The extremes of each front get an infinite distance and
+ * unevaluated individuals a distance of 0
+ */
+template <typename T>
+void crowdingDistance(std::vector<T*>& ind, const std::vector<int>& rank, std::vector<double>& crowding) {
+	std::vector<double> obj;
+	std::vector<char> evaluated;
+	int m = objectiveMatrix(ind, obj, evaluated);
+	int n = ind.size();
+	crowding.assign(n, 0.0);
+	if (n == 0 || m == 0) {
+		return;
+	}
+	int numFronts = *std::max_element(rank.begin(), rank.end()) + 1;
+	std::vector<std::vector<int> > fronts(numFronts);
+	for (int i = 0; i < n; ++i) {
+		if (evaluated[i]) {
+			fronts[rank[i]].push_back(i);
+		}
+	}
+	const double inf = std::numeric_limits<double>::infinity();
+	for (int f = 0; f < numFronts; ++f) {
+		std::vector<int>& front = fronts[f];
+		int size = front.size();
+		if (size == 0) {
+			continue;
+		}
+		for (int j = 0; j < m; ++j) {
+			ObjectiveOrder cmp = { &obj[0], m, j };
+			std::sort(front.begin(), front.end(), cmp);
+			double lo = obj[front.front() * m + j], hi = obj[front.back() * m + j];
+			crowding[front.front()] = inf;
+			crowding[front.back()] = inf;
+			if (hi <= lo) {
+				continue;
+			}
+			for (int i = 1; i < size - 1; ++i) {
+				crowding[front[i]] += (obj[front[i + 1] * m + j] - obj[front[i - 1] * m + j]) / (hi - lo);
+			}
+		}
+	}
+}
+
+template <typename T>
+struct NsgaEntry {
+	int rank;
+	double crowding;
+	T* individual;
+	bool operator<(const NsgaEntry& e) const {
+		return rank < e.rank || (rank == e.rank && crowding > e.crowding);
+	}
+};
+
+/*!
+ * Order individuals by front, then by decreasing crowding distance
+ * After sorting, the first individuals are the ones NSGA-II selects
+ */
+template <typename T>
+void nsgaSort(std::vector<T*>& ind) {
+	std::vector<int> rank;
+	std::vector<double> crowding;
+	nondominatedSort(ind, rank);
+	crowdingDistance(ind, rank, crowding);
+	std::vector<NsgaEntry<T> > entries(ind.size());
+	for (unsigned int i = 0; i < ind.size(); ++i) {
+		entries[i].rank = rank[i];
+		entries[i].crowding = crowding[i];
+		entries[i].individual = ind[i];
+	}
+	std::stable_sort(entries.begin(), entries.end());
+	for (unsigned int i = 0; i < ind.size(); ++i) {
+		ind[i] = entries[i].individual;
+	}
+}
+
+}
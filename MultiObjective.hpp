@@ -0,0 +1,32 @@
+#ifndef _MULTIOBJECTIVE_HPP_
+#define _MULTIOBJECTIVE_HPP_
+
+#include <vector>
+
+namespace ESP {
+
+/*!
+ * NSGA-II style multi-objective ranking
+ * Works on any individual type with getNumObjectives and
+ * getObjective, i.e. Neurons and Networks. All objectives are
+ * maximized; an Environment that minimizes a cost such as network
+ * size reports its negative. Fronts are found with the efficient
+ * non-dominated sort (ENS-BS): once the individuals are sorted
+ * lexicographically an individual can only be dominated by the ones
+ * before it, and its front is found by a binary search over the
+ * fronts found so far. This needs far fewer dominance comparisons
+ * than the O(M N^2) fast non-dominated sort
+ */
+template <typename T>
+void nondominatedSort(std::vector<T*>&, std::vector<int>&);
+
+template <typename T>
+void crowdingDistance(std::vector<T*>&, const std::vector<int>&, std::vector<double>&);
+
+template <typename T>
+void nsgaSort(std::vector<T*>&);
+
+}
+
+#include "MultiObjective.cpp"
+#endif
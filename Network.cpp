@@ -1,9 +1,11 @@
 #include "Network.hpp"
 #include "Neuron.hpp"
 #include <cmath>
+#include <algorithm>
 #include <cstdio>
 #include <fstream>
 #include <boost/random.hpp>
+#include <boost/atomic.hpp>
 #include <ctime>
 
 std::ostream& operator<<(std::ostream& os, ESP::Network &net) {
@@ -16,28 +18,28 @@ std::ostream& operator<<(std::ostream& os, ESP::Network &net) {
 
 namespace ESP {
 
-Network::Network(int n, int hid, int out) : activation(hid),
- 											hiddenUnits(hid),
- 											trials(0),
+/*!
+ * Source of Network IDs, shared by every thread
+ */
+static boost::atomic<int> networkCounter(0);
+
+Network::Network(int n, int hid, int out) : hiddenUnits(hid),
+ 											activation(hid),
  											fitness(0.0),
+ 											trials(0),
  											parent1(-1),
  											parent2(-1),
  											created(false),
- 											numInputs(in),
+ 											numInputs(n),
  											numOutputs(out),
  											bias(0.0) {
- 	static int counter = 0;
- 	id = ++counter;
+ 	id = ++networkCounter;
 }
 
 Network::~Network() {
 	deleteNeurons();
 }
 
-inline double Network::sigmoid(double x, double slope) {
-	return (1.0 / (1.0 + exp(-(slope * x))));
-}
-
 /*!
  * Delete the Neurons
  */
@@ -68,6 +70,27 @@ void Network::setFitness(double fit) {
 	fitness += fit;
 }
 
+/*!
+ * Add the objective values of a trial
+ * Must be called before setFitness, which counts the trial
+ */
+void Network::setObjectives(const std::vector<double>& obj) {
+	if (objectives.size() != obj.size()) {
+		objectives.assign(obj.size(), 0.0);
+	}
+	for (unsigned int i = 0; i < obj.size(); ++i) {
+		objectives[i] += obj[i];
+	}
+}
+
+double Network::getObjective(int i) {
+	if (i < 0 || i >= (int)objectives.size()) {
+		std::cerr << "Objective index out of bounds; Network::getObjective" << std::endl;
+		abort();
+	}
+	return trials ? objectives[i] / (double)trials : objectives[i];
+}
+
 double Network::getFitness() {
 	if (trials) {
 		return fitness / (double)trials;
@@ -76,10 +99,10 @@ double Network::getFitness() {
 	}
 }
 
-void Network::create() {
+void Network::create(boost::mt19937& rng) {
 	for (int i = 0; i < hiddenUnits.size(); ++i) {
 		hiddenUnits[i] = new Neuron(geneSize);
-		hiddenUnits[i]->create();
+		hiddenUnits[i]->create(rng);
 	}
 	created = true;
 }
@@ -102,18 +125,19 @@ bool Network::sizeEqual(Network& n) {
 }
 
 void Network::operator=(Network& n) {
-	if (n.created) {
+	if (!n.created) {
 		std::cerr << "Assigning uncreated Network; Network::operator=" << std::endl;
 		abort();
 	}
 	// Check if Networks are of the same type
-	if (type != n.type) {
+	if (&getDescriptor() != &n.getDescriptor()) {
 		std::cerr << "Assigning Networks of type " << n.getName() << " to type " << getName() << "; Network::operator=" << std::endl;
 		abort();
 	}
 	activation = n.activation;
 	trials = n.trials;
 	fitness = n.fitness;
+	objectives = n.objectives;
 	parent1 = n.parent1;
 	parent2 = n.parent2;
 	geneSize = n.geneSize;
@@ -123,7 +147,7 @@ void Network::operator=(Network& n) {
 	deleteNeurons();
 	hiddenUnits.clear();
 	for (int i = 0; i < n.getNumNeurons(); ++i) {
-		hiddenUnits.push_back(new Neuron(geneSize));
+		hiddenUnits.push_back(n.hiddenUnits[i]->clone());
 		*hiddenUnits[i] = *n.hiddenUnits[i];
 	}
 	created = true;
@@ -156,15 +180,16 @@ void Network::setNeuron(Neuron* n, int position) {
 	hiddenUnits[position] = n;
 }
 
-inline Neuron* Network::getNeuron(int i) {
+Neuron* Network::getNeuron(int i) {
 	if (i >= 0 && i < (int)hiddenUnits.size()) {
 		return hiddenUnits[i];
 	} else {
 		std::cerr << "Index out of bounds; Network::getNeuron" << std::endl;
+		return 0;
 	}
 }
 
-inline int Network::getParent(int p) {
+int Network::getParent(int p) {
 	if (p == 1) {
 		return parent1;
 	} else if (p == 2) {
@@ -174,7 +199,7 @@ inline int Network::getParent(int p) {
 	}
 }
 
-inline Network::setParent(int p, int id) {
+void Network::setParent(int p, int id) {
 	if (p == 1) {
 		parent1 = id;
 	} else if (p == 2) {
@@ -189,13 +214,21 @@ void Network::setNetwork(Network* n) {
 	parent2 = n->parent2;
 	fitness = n->fitness;
 	trials = n->trials;
+	objectives = n->objectives;
 	for (int i = 0; i < hiddenUnits.size(); ++i) {
 		hiddenUnits[i] = n->hiddenUnits[i];
 	}
 }
 
 void Network::addFitness() {
-	for (int i = 0; i < hiddenUnits.size() ++i) {
+	std::vector<double> obj(objectives.size());
+	for (unsigned int i = 0; i < objectives.size(); ++i) {
+		obj[i] = getObjective(i);
+	}
+	for (int i = 0; i < hiddenUnits.size(); ++i) {
+		if (!obj.empty()) {
+			hiddenUnits[i]->addObjectives(obj);
+		}
 		hiddenUnits[i]->addFitness(fitness);
 	}
 }
@@ -204,38 +237,64 @@ void Network::resetActivation() {
 	for (int i = 0; i < hiddenUnits.size(); ++i) {
 		activation[i] = 0.0;
 	}
+	laneActivation.clear();
 }
 
 /*!
  * Used by complete
  */
-void Network::perturb(Network* net) {
+void Network::perturb(Network* net, boost::mt19937& rng) {
 	for (int i = 0; i < hiddenUnits.size(); ++i) {
-		hiddenUnits[i]->perturb(net->hiddenUnits[i], rndCauchy, 0.01);
+		hiddenUnits[i]->perturb(net->hiddenUnits[i], 0.01, rng);
 	}
 }
 
 /*!
  * Same as above but called on self and returns new Network
  */
-Network* Network::perturb(double coeff) {
+Network* Network::perturb(double coeff, boost::mt19937& rng) {
 	Network* n = this->clone();
 	for (int i = 0; i < hiddenUnits.size(); ++i) {
-		n->hiddenUnits[i] = hiddenUnits[i]->perturb(0.05);
+		n->hiddenUnits[i] = hiddenUnits[i]->perturb(0.05, rng);
 	}
 	n->created = true;
 	return n;
 }
 
-void Network::mutate(double mutRate) {
-	boost::mt19937 rng(time(0));
+void Network::mutate(double mutRate, boost::mt19937& rng) {
 	boost::uniform_real<> rdist(0.0, 1.0);
 	if (rdist(rng) < mutRate) {
 		boost::uniform_int<> idist(0, hiddenUnits.size() - 1);
-		hiddenUnits[idist(rng)]->mutate();
+		hiddenUnits[idist(rng)]->mutate(rng);
 	} 
 }
 
+/*!
+ * Activate the Network on a batch of inputs
+ * Inputs and outputs are stored row-major, one row per batch
+ * entry.  Every row is a separate lane with its own activation, so
+ * a recurrent Network carries the state of a lane from one call to
+ * the next and never from one lane to another.  The lanes are
+ * reset by resetActivation.  The default implementation swaps the
+ * state of each lane in and out of activation around activate;
+ * derived classes should override it with a true batched kernel
+ */
+void Network::activateBatch(std::vector<double>& inputs, std::vector<double>& outputs, int batch) {
+	int hid = activation.size();
+	std::vector<double> in(numInputs), out(numOutputs);
+	if ((int)laneActivation.size() != batch * hid) {
+		laneActivation.assign(batch * hid, 0.0);
+	}
+	outputs.resize(batch * numOutputs);
+	for (int b = 0; b < batch; ++b) {
+		std::copy(inputs.begin() + b * numInputs, inputs.begin() + (b + 1) * numInputs, in.begin());
+		std::copy(laneActivation.begin() + b * hid, laneActivation.begin() + (b + 1) * hid, activation.begin());
+		activate(in, out);
+		std::copy(activation.begin(), activation.end(), laneActivation.begin() + b * hid);
+		std::copy(out.begin(), out.end(), outputs.begin() + b * numOutputs);
+	}
+}
+
 void Network::printActivation(FILE* file) {
 	for (int i = 0; i < hiddenUnits.size(); ++i) {
 		fprintf(file, "%f ", activation[i]);
@@ -258,10 +317,10 @@ void Network::removeConnection(int locus) {
 }
 
 void Network::saveText(std::string fname) {
-	std::string newname = fname + name;
+	std::string newname = fname + getName();
 	std::ofstream file(newname.c_str(), std::ofstream::out);
 	if (file) {
-		file << type << std::endl;
+		file << getType() << std::endl;
 		file << numInputs << std::endl;
 		file << hiddenUnits.size() << std::endl;
 		file << numOutputs << std::endl;
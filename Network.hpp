@@ -2,9 +2,12 @@
 #define _NETWORK_HPP_
 
 #include "Environment.hpp"
+#include "Neuron.hpp"
+#include "TypeDescriptor.hpp"
 #include <vector>
 #include <string>
 #include <ostream>
+#include <cmath>
 
 namespace ESP {
 
@@ -14,24 +17,26 @@ class Neuron;
  * Neural network base class
  * Virtual class for neural networks consisting of a vector of Neurons that are
  * connected through the implementation is an activation function in the derived
- * classes 
+ * classes. Derived classes identify themselves through a static TypeDescriptor
+ * returned by getDescriptor; the members used during evaluation come first
  */
 class Network {
 protected:
-	std::vector<double> activation;
 	std::vector<Neuron*> hiddenUnits;
-	int trials;
+	std::vector<double> activation;
+	std::vector<double> laneActivation;	///< Activation of every lane of activateBatch, row-major
 	double fitness;
+	int trials;
 	int id;
 	int parent1;
 	int parent2;
 	int geneSize;
-	std::string name;
-	int type;
+	std::vector<double> objectives;	///< Summed objective values, averaged over trials like fitness
 	void setFitness(double);
+	void setObjectives(const std::vector<double>&);
 	void addConnection(int);
 	void removeConnection(int);
-	double sigmoid(double x, double slope = 1.0);
+	inline double sigmoid(double x, double slope = 1.0) { return (1.0 / (1.0 + exp(-(slope * x)))); };
 public:
 	bool created;
 	int numInputs;
@@ -42,38 +47,50 @@ public:
 	virtual ~Network();
 	virtual Network* newNetwork(int, int, int) = 0;
 	virtual Network* clone() = 0;
+	virtual const TypeDescriptor& getDescriptor() = 0;
 	virtual void growNeuron(Neuron*) = 0;
 	virtual void shrinkNeuron(Neuron*, int) = 0;
 	virtual void addNeuron() = 0;
 	virtual void removeNeuron(int) = 0;
 	virtual void activate(std::vector<double>&, std::vector<double>&) = 0;
+	virtual void activateBatch(std::vector<double>&, std::vector<double>&, int);
+	virtual void rehome() {};	///< Move the weights the Network activates from into memory of the calling thread's node
 	inline virtual int getMinUnits() { return 1; };
 	void releaseNeurons();
 	void deleteNeurons();
 	void operator=(Network& n);
-	void operator==(Network& n);
-	void operator!=(Network& n);
-	void create();
+	bool operator==(Network& n);
+	bool operator!=(Network& n);
+	void create() { create(defaultRng()); };
+	virtual void create(boost::mt19937&);
 	void resetActivation();
 	void setNeuron(Neuron*, int);
 	void setNetwork(Network*);
 	void addFitness();
-	void perturb(Network*);
-	Network* perturb(double coeff = 0.3);
-	void mutate(double);
+	void perturb(Network* net) { perturb(net, defaultRng()); };
+	void perturb(Network*, boost::mt19937&);
+	Network* perturb(double coeff = 0.3) { return perturb(coeff, defaultRng()); };
+	Network* perturb(double, boost::mt19937&);
+	void mutate(double mutRate) { mutate(mutRate, defaultRng()); };
+	void mutate(double, boost::mt19937&);
 	void printActivation(FILE*);
 	void saveText(std::string);
-	void resetFitness() { fitness = 0.0; trials = 0; };
+	void resetFitness() { fitness = 0.0; trials = 0; objectives.clear(); };
 	friend double Environment::evaluateNetwork(Network*);
+	friend class Surrogate;
+	friend class Refiner;
+	friend class ChampionBuffer;
 	inline int getNumNeurons() { return (int)hiddenUnits.size(); };
 	double getFitness();
+	double getObjective(int);
+	inline int getNumObjectives() { return objectives.size(); };
 	Neuron* getNeuron(int);
 	inline int getID() { return id; };
 	int getParent(int);
 	inline int getGeneSize() { return geneSize; };
 	void setParent(int, int);
-	std::string getName() { return name; };
-	int getType() { return type; };
+	std::string getName() { return getDescriptor().name; };
+	int getType() { return getDescriptor().type; };
 private:
 	bool sizeEqual(Network& n);
 };
@@ -2,23 +2,102 @@
 #include "Environment.hpp"
 #include "Neuron.hpp"
 #include "Network.hpp"
+#include "SparseNeuron.hpp"
+#include "Population.hpp"
 #include <algorithm>
+#include <iostream>
 #include <boost/random.hpp>
 #include <ctime>
 
 namespace ESP {
 
-NeuroEvolution::NeuroEvolution(Environment &e) : inputDimension(e.getInputDimention()),
-												 outputDimension(e.getOutputDimension()),
-												 evaluations(0),
-												 envt(e) {
-	envt.setNePtr(this);
+/*!
+ * The genetic operators draw from r if given, so a run that owns
+ * a stream keeps a single stream for all its random choices.
+ * Otherwise the NeuroEvolution has its own stream seeded from the
+ * clock
+ */
+NeuroEvolution::NeuroEvolution(Environment &e, boost::mt19937* r) : ownRng(time(0)),
+																	inputDimension(e.getInputDimension()),
+																	outputDimension(e.getOutputDimension()),
+																	evaluations(0),
+																	prunedEvaluations(0),
+																	minimize(false),
+																	novelty(0),
+																	racing(false),
+																	raceCutoff(0.0),
+																	envt(e),
+																	rng(r ? *r : ownRng) {
+	envt.setNetPtr(this);
+}
+
+/*!
+ * Reseed the generator used by the genetic operators
+ * Runs that share a process but must not share a random stream
+ * each get their own seed. Reseeds the run's stream if the
+ * NeuroEvolution was given one
+ */
+void NeuroEvolution::setSeed(unsigned int seed) {
+	rng.seed(seed);
+}
+
+/*!
+ * Draw the common episodes of a generation
+ * Called once per generation, while no evaluation is running; every
+ * Network of the generation is then evaluated on the same trials
+ * episodes by evaluateEpisodes, here or in Environment
+ */
+void NeuroEvolution::newEpisodeSeeds(int trials) {
+	episodeSeeds.resize(trials);
+	for (int i = 0; i < trials; ++i) {
+		episodeSeeds[i] = rng();
+	}
+}
+
+/*!
+ * Evaluate a Network on the episodes of the generation
+ * Returns the mean fitness over the episodes. Without common
+ * episodes the Network is evaluated once on a fresh episode
+ */
+double NeuroEvolution::evaluateEpisodes(Network* net) {
+	return envt.evaluateEpisodes(net, episodeSeeds);
+}
+
+/*!
+ * Set the race cutoff of the next generation
+ * Must be called at the end of every generation, once the
+ * subpopulations have been sorted, since nothing else updates the
+ * cutoff. A Network is worth finishing as long as it can reach the
+ * fitness of the worst breeding Neuron of any subpopulation, so the
+ * cutoff is the lowest of their breed cutoffs
+ */
+void NeuroEvolution::setRaceCutoff(std::vector<NeuronPop*>& subpops) {
+	if (subpops.empty()) {
+		return;
+	}
+	raceCutoff = subpops[0]->getBreedCutoff();
+	for (unsigned int i = 1; i < subpops.size(); ++i) {
+		raceCutoff = std::min(raceCutoff, subpops[i]->getBreedCutoff());
+	}
+}
+
+/*!
+ * Abort unless all four Neurons are dense
+ * The crossovers below pair weights by position, which is meaningless
+ * for SparseNeurons, whose weights belong to different inputs
+ */
+static void requireDense(Neuron* parent1, Neuron* parent2, Neuron* child1, Neuron* child2, const char* method) {
+	if (!parent1->isDense() || !parent2->isDense() || !child1->isDense() || !child2->isDense()) {
+		std::cerr << "Crossover of sparse Neurons, use the SparseNeuron overload; NeuroEvolution::" << method << std::endl;
+		abort();
+	}
 }
 
 /*!
  * Arithmetic crossover
  */
 void NeuroEvolution::crossoverArithmetic(Neuron* parent1, Neuron* parent2, Neuron* child1, Neuron* child2) {
+	requireDense(parent1, parent2, child1, child2, "crossoverArithmetic");
 	child1->parent1 = parent1->getID();
 	child1->parent2 = parent2->getID();
 	child2->parent1 = parent1->getID();
@@ -36,17 +115,17 @@ void NeuroEvolution::crossoverArithmetic(Neuron* parent1, Neuron* parent2, Neuro
  * Another linear combination crossover
  */
 void NeuroEvolution::crossoverEir(Neuron* parent1, Neuron* parent2, Neuron* child1, Neuron* child2) {
+	requireDense(parent1, parent2, child1, child2, "crossoverEir");
 	child1->parent1 = parent1->getID();
 	child1->parent2 = parent2->getID();
 	child2->parent1 = parent1->getID();
 	child2->parent2 = parent2->getID();
 	double d = 0.4;
 	double d2 = 2.0 * d + 1;
-	boost::mt19937 rng(time(0));
 	boost::uniform_real<> dist(0.0, 1.0);
 	for (int i = 0; i < parent1->getSize(); ++i) {
-		child1->setWeight(i, parent1->getWeight(i) + (d2 * dist(rng) - d) * (parent2->getWeight(i) - parent1.getWeight(i)));
-		child2->setWeight(i, parent2->getWeight(i) + (d2 * dist(rng) - d) * (parent1->getWeight(i) - parent2.getWeight(i)));
+		child1->setWeight(i, parent1->getWeight(i) + (d2 * dist(rng) - d) * (parent2->getWeight(i) - parent1->getWeight(i)));
+		child2->setWeight(i, parent2->getWeight(i) + (d2 * dist(rng) - d) * (parent1->getWeight(i) - parent2->getWeight(i)));
 	}
 }
 
@@ -56,7 +135,7 @@ void NeuroEvolution::crossoverEir(Neuron* parent1, Neuron* parent2, Neuron* chil
  * by exchanging chromosomal sub-strings at a random crossover point
  */
 void NeuroEvolution::crossoverOnePoint(Neuron* parent1, Neuron* parent2, Neuron* child1, Neuron* child2) {
-	boost::mt19937 rng(time(0));
+	requireDense(parent1, parent2, child1, child2, "crossoverOnePoint");
 	boost::uniform_int<> dist1(0, parent1->getSize() - 1);
 	boost::uniform_int<> dist2(0, parent2->getSize() - 1);
 	int cross1 = dist1(rng);
@@ -85,7 +164,6 @@ void NeuroEvolution::crossoverOnePoint(Neuron* parent1, Neuron* parent2, Neuron*
  * by exchanging chromosomal sub-strings at a random crossover point
  */
 void NeuroEvolution::crossoverOnePoint(Network* parent1, Network* parent2, Network* child1, Network* child2) {
-	boost::mt19937 rng(time(0));
 	boost::uniform_int<> dist1(0, parent1->getNumNeurons() - 1);
 	boost::uniform_int<> dist2(0, parent2->getNumNeurons() - 1);
 	int crossNeuron = dist1(rng);
@@ -141,4 +219,221 @@ void NeuroEvolution::crossoverArithmetic(Network* parent1, Network* parent2, Net
 	child2->setParent(2, parent2->getID());
 }
 
+/*!
+ * Prepare the children of a Mating for a recombination kernel
+ * Checks once that all the weight rows have the same size, so the
+ * kernels can work on the raw rows without bounds checking, and
+ * sets the parents, fitness and ID of the children. The kernels
+ * write the children while still reading the parents, so the two
+ * child slots must differ from each other and from both parents
+ */
+static int prepareMating(Neuron* parent1, Neuron* parent2, Neuron* child1, Neuron* child2) {
+	if (child1 == child2 || child1 == parent1 || child1 == parent2 || child2 == parent1 || child2 == parent2) {
+		std::cerr << "Child slot overlaps a parent or the other child; NeuroEvolution::prepareMating" << std::endl;
+		abort();
+	}
+	requireDense(parent1, parent2, child1, child2, "prepareMating");
+	int size = parent1->getSize();
+	if ((int)parent2->getSize() != size || (int)child1->getSize() != size || (int)child2->getSize() != size) {
+		std::cerr << "Weight rows of different size; NeuroEvolution::prepareMating" << std::endl;
+		abort();
+	}
+	child1->parent1 = parent1->getID();
+	child1->parent2 = parent2->getID();
+	child2->parent1 = parent1->getID();
+	child2->parent2 = parent2->getID();
+	child1->resetFitness();
+	child2->resetFitness();
+	return size;
+}
+
+/*!
+ * One-point crossover for a whole subpopulation
+ * Every Mating exchanges the prefixes of the parents' weight rows
+ * at its own random crossover point. The rows are copied as
+ * contiguous blocks instead of weight by weight
+ */
+void NeuroEvolution::crossoverOnePoint(std::vector<Neuron*>& pop, const std::vector<Mating>& matings) {
+	for (unsigned int m = 0; m < matings.size(); ++m) {
+		Neuron* parent1 = pop[matings[m].parent1];
+		Neuron* parent2 = pop[matings[m].parent2];
+		Neuron* child1 = pop[matings[m].child1];
+		Neuron* child2 = pop[matings[m].child2];
+		int size = prepareMating(parent1, parent2, child1, child2);
+		boost::uniform_int<> dist(0, size - 1);
+		int cross = dist(rng);
+		const double* w1 = &parent1->weight[0];
+		const double* w2 = &parent2->weight[0];
+		std::copy(w1, w1 + cross, child1->weight.begin());
+		std::copy(w2 + cross, w2 + size, child1->weight.begin() + cross);
+		std::copy(w2, w2 + cross, child2->weight.begin());
+		std::copy(w1 + cross, w1 + size, child2->weight.begin() + cross);
+		child1->newID();
+		child2->newID();
+	}
+}
+
+/*!
+ * Arithmetic crossover for a whole subpopulation
+ * Same operator as crossoverArithmetic(Neuron*, ...) but produces
+ * the children of every Mating in one pass over the weight rows
+ */
+void NeuroEvolution::crossoverArithmetic(std::vector<Neuron*>& pop, const std::vector<Mating>& matings) {
+	const double a = 0.25, b = 0.75;
+	for (unsigned int m = 0; m < matings.size(); ++m) {
+		Neuron* parent1 = pop[matings[m].parent1];
+		Neuron* parent2 = pop[matings[m].parent2];
+		Neuron* child1 = pop[matings[m].child1];
+		Neuron* child2 = pop[matings[m].child2];
+		int size = prepareMating(parent1, parent2, child1, child2);
+		const double* w1 = &parent1->weight[0];
+		const double* w2 = &parent2->weight[0];
+		double* c1 = &child1->weight[0];
+		double* c2 = &child2->weight[0];
+		for (int i = 0; i < size; ++i) {
+			c1[i] = a * w1[i] + b * w2[i];
+			c2[i] = a * w2[i] + b * w1[i];
+		}
+		child1->newID();
+		child2->newID();
+	}
+}
+
+/*!
+ * Eir crossover for a whole subpopulation
+ * The random blend coefficients of a row are drawn up front, in the
+ * order crossoverEir(Neuron*, ...) draws them, so that the blending
+ * loop itself has no calls in it
+ */
+void NeuroEvolution::crossoverEir(std::vector<Neuron*>& pop, const std::vector<Mating>& matings) {
+	double d = 0.4;
+	double d2 = 2.0 * d + 1;
+	boost::uniform_real<> dist(0.0, 1.0);
+	std::vector<double> coeff;
+	for (unsigned int m = 0; m < matings.size(); ++m) {
+		Neuron* parent1 = pop[matings[m].parent1];
+		Neuron* parent2 = pop[matings[m].parent2];
+		Neuron* child1 = pop[matings[m].child1];
+		Neuron* child2 = pop[matings[m].child2];
+		int size = prepareMating(parent1, parent2, child1, child2);
+		coeff.resize(2 * size);
+		for (int i = 0; i < 2 * size; ++i) {
+			coeff[i] = d2 * dist(rng) - d;
+		}
+		const double* w1 = &parent1->weight[0];
+		const double* w2 = &parent2->weight[0];
+		const double* r = &coeff[0];
+		double* c1 = &child1->weight[0];
+		double* c2 = &child2->weight[0];
+		for (int i = 0; i < size; ++i) {
+			c1[i] = w1[i] + r[2 * i] * (w2[i] - w1[i]);
+			c2[i] = w2[i] + r[2 * i + 1] * (w1[i] - w2[i]);
+		}
+		child1->newID();
+		child2->newID();
+	}
+}
+
+/*!
+ * Mutation for a whole subpopulation
+ * Same operator as Population::mutate: every row from first on is
+ * mutated with probability mutRate by adding Cauchy noise to one
+ * random weight, with the draws taken from rng in the same order.
+ * The weight is written straight into the row, without the virtual
+ * call and bounds check of Neuron::mutate
+ */
+void NeuroEvolution::mutate(std::vector<Neuron*>& pop, int first, double mutRate) {
+	boost::uniform_real<> dist(0.0, 1.0);
+	for (unsigned int i = first; i < pop.size(); ++i) {
+		if (dist(rng) < mutRate) {
+			Neuron* n = pop[i];
+			if (!n->isDense() || n->weight.empty()) {
+				std::cerr << "Mutation of a sparse or empty Neuron, use Neuron::mutate; NeuroEvolution::mutate" << std::endl;
+				abort();
+			}
+			boost::uniform_int<> pick(0, n->weight.size() - 1);
+			n->weight[pick(rng)] += rndCauchy(0.3, rng);
+			n->newID();
+		}
+	}
+}
+
+/*!
+ * Start the children of two sparse parents
+ */
+static void prepareSparse(SparseNeuron* parent1, SparseNeuron* parent2, SparseNeuron* child1, SparseNeuron* child2) {
+	if (parent1->getDimension() != parent2->getDimension()) {
+		std::cerr << "Sparse neurons of different dimension; NeuroEvolution::prepareSparse" << std::endl;
+		abort();
+	}
+	*child1 = *parent1;
+	*child2 = *parent2;
+	child1->parent1 = parent1->getID();
+	child1->parent2 = parent2->getID();
+	child2->parent1 = parent1->getID();
+	child2->parent2 = parent2->getID();
+	child1->resetFitness();
+	child2->resetFitness();
+}
+
+/*!
+ * One-point crossover for SparseNeurons
+ * The crossover point is a position in the dense weight vector; the
+ * children take the connections before it from one parent and the
+ * connections after it from the other
+ */
+void NeuroEvolution::crossoverOnePoint(SparseNeuron* parent1, SparseNeuron* parent2, SparseNeuron* child1, SparseNeuron* child2) {
+	prepareSparse(parent1, parent2, child1, child2);
+	boost::uniform_int<> dist(0, parent1->getDimension() - 1);
+	int cross = dist(rng);
+	int s1 = std::lower_bound(parent1->index.begin(), parent1->index.end(), cross) - parent1->index.begin();
+	int s2 = std::lower_bound(parent2->index.begin(), parent2->index.end(), cross) - parent2->index.begin();
+	child1->index.assign(parent1->index.begin(), parent1->index.begin() + s1);
+	child1->index.insert(child1->index.end(), parent2->index.begin() + s2, parent2->index.end());
+	child1->weight.assign(parent1->weight.begin(), parent1->weight.begin() + s1);
+	child1->weight.insert(child1->weight.end(), parent2->weight.begin() + s2, parent2->weight.end());
+	child2->index.assign(parent2->index.begin(), parent2->index.begin() + s2);
+	child2->index.insert(child2->index.end(), parent1->index.begin() + s1, parent1->index.end());
+	child2->weight.assign(parent2->weight.begin(), parent2->weight.begin() + s2);
+	child2->weight.insert(child2->weight.end(), parent1->weight.begin() + s1, parent1->weight.end());
+	child1->newID();
+	child2->newID();
+}
+
+/*!
+ * Blend the connections of parent with those of other
+ * The child keeps exactly the connections of parent: the ones other
+ * also has are blended as in crossoverArithmetic, the rest are
+ * inherited unchanged
+ */
+static void blendSparse(const std::vector<int>& index, const std::vector<double>& w, const std::vector<int>& otherIndex,
+						const std::vector<double>& otherW, double a, double b, std::vector<double>& child) {
+	child.resize(w.size());
+	unsigned int q = 0;
+	for (unsigned int p = 0; p < index.size(); ++p) {
+		while (q < otherIndex.size() && otherIndex[q] < index[p]) {
+			++q;
+		}
+		child[p] = (q < otherIndex.size() && otherIndex[q] == index[p]) ? a * w[p] + b * otherW[q] : w[p];
+	}
+}
+
+/*!
+ * Arithmetic crossover for SparseNeurons
+ * Each child keeps the connections of one parent, so crossover never
+ * makes a Neuron denser; connections that both parents have are
+ * blended as in crossoverArithmetic
+ */
+void NeuroEvolution::crossoverArithmetic(SparseNeuron* parent1, SparseNeuron* parent2, SparseNeuron* child1, SparseNeuron* child2) {
+	prepareSparse(parent1, parent2, child1, child2);
+	double a = 0.25, b = 0.75;
+	std::vector<double> v1, v2;
+	blendSparse(parent1->index, parent1->weight, parent2->index, parent2->weight, a, b, v1);
+	blendSparse(parent2->index, parent2->weight, parent1->index, parent1->weight, a, b, v2);
+	child1->weight.swap(v1);
+	child2->weight.swap(v2);
+	child1->newID();
+	child2->newID();
+}
+
 }
\ No newline at end of file
@@ -1,11 +1,30 @@
 #ifndef _NEUROEVOLUTION_HPP_
 #define _NEUROEVOLUTION_HPP_
 
+#include <vector>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/atomic.hpp>
+
 namespace ESP {
 
 class Neuron;
+class SparseNeuron;
 class Network;
 class Environment;
+class NoveltyArchive;
+template <typename T> class Population;
+typedef Population<Neuron> NeuronPop;
+
+/*!
+ * Indices into a subpopulation of the two parents
+ * and the two child slots of a single mating
+ */
+struct Mating {
+	int parent1;
+	int parent2;
+	int child1;
+	int child2;
+};
 
 /*!
  * Base class for other NeuroEvolution algorithms
@@ -16,13 +35,24 @@ class Environment;
  */
 class NeuroEvolution {
 protected:
+	boost::mt19937 ownRng;		///< Stream of the genetic operators when none is given
 	int inputDimension; 		///< The number of variables that the nets receive as inputs
 	int outputDimension;		///< The number of variables in the action space
-	int evaluations;			///< The number of Network evaluations
+	boost::atomic<int> evaluations;			///< The number of Network evaluations, counted from any thread
+	boost::atomic<int> prunedEvaluations;	///< The number of Network evaluations abandoned by racing
 public:
 	bool minimize;				///< Whether or not fitness is maximized or minimized
+	NoveltyArchive* novelty;	///< Behavior archive for novelty search, 0 to use task fitness
+	bool racing;				///< Whether evaluations that cannot beat raceCutoff are abandoned
+	double raceCutoff;			///< Fitness a Network must be able to reach to finish its evaluation, set each generation by setRaceCutoff
 	Environment& envt;			///< The task environment
-	NeuroEvolution(Environment& e);
+	boost::mt19937& rng;		///< Random stream of the genetic operators, the run's stream if one was given
+	std::vector<unsigned int> episodeSeeds;	///< Episodes every Network is evaluated on this generation, empty for fresh episodes
+	NeuroEvolution(Environment& e, boost::mt19937* r = 0);
+	void setSeed(unsigned int);
+	void newEpisodeSeeds(int);
+	double evaluateEpisodes(Network*);
+	void setRaceCutoff(std::vector<NeuronPop*>&);
 	int getInDim() { return inputDimension; };
 	int getOutDim() { return outputDimension; };
 	// Genetic operators
@@ -32,7 +62,17 @@ public:
 	void crossoverOnePoint(Network*, Network*, Network*, Network*);
 	void crossoverArithmetic(Network*, Network*, Network*, Network*);
 	void crossoverNPoint(Network*, Network*, Network*, Network*);
+	void crossoverOnePoint(SparseNeuron*, SparseNeuron*, SparseNeuron*, SparseNeuron*);
+	void crossoverArithmetic(SparseNeuron*, SparseNeuron*, SparseNeuron*, SparseNeuron*);
+	// Subpopulation-level genetic operators
+	void crossoverOnePoint(std::vector<Neuron*>&, const std::vector<Mating>&);
+	void crossoverArithmetic(std::vector<Neuron*>&, const std::vector<Mating>&);
+	void crossoverEir(std::vector<Neuron*>&, const std::vector<Mating>&);
+	void mutate(std::vector<Neuron*>&, int, double);
 	void incEvals() { ++evaluations; };
+	void incPruned() { ++prunedEvaluations; };
+	int getEvals() { return evaluations; };
+	int getPruned() { return prunedEvaluations; };
 };
 
 }
@@ -1,7 +1,11 @@
 #include "Neuron.hpp"
 #include <cmath>
 #include <ctime>
+#include <cstdlib>
+#include <iostream>
 #include <boost/random.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/tss.hpp>
 
 #define PI 3.1415926535897931 
 
@@ -18,36 +22,94 @@ std::ostream& operator<<(std::ostream& os, ESP::Neuron& n) {
 /*!
  * Generates a random number from a Cauchy distribution centered in zero
  */
-double rndCauchy(double wtrange) {
+double rndCauchy(double wtrange, boost::mt19937& rng) {
 	double u = 0.5, Cauchy_cut = 10.0;
-	boost::mt19937 rng(time(0));
 	boost::uniform_real<> dist(0.0, 1.0);
 	while (u == 0.5) {
 		u = dist(rng);
 	}
 	u = wtrange * tan(u * PI);
 	if (fabs(u) > Cauchy_cut) {
-		return rndCauchy(wtrange);
+		return rndCauchy(wtrange, rng);
 	} else {
 		return u;
 	}
 }
 
+double rndCauchy(double wtrange) {
+	return rndCauchy(wtrange, ESP::defaultRng());
+}
+
 namespace ESP {
 
-Neuron::Neuron(int size) : lesioned(false),
+static boost::thread_specific_ptr<boost::mt19937> threadRng;
+static boost::atomic<unsigned int> threadRngCount(0);
+
+/*!
+ * Random generator of the calling thread
+ * Seeded once per thread from the clock and a thread count, so
+ * threads get different streams and repeated calls continue the
+ * stream instead of restarting it
+ */
+boost::mt19937& defaultRng() {
+	if (!threadRng.get()) {
+		threadRng.reset(new boost::mt19937(time(0) + 7919 * ++threadRngCount));
+	}
+	return *threadRng;
+}
+
+/*!
+ * Source of Neuron IDs, shared by every thread
+ */
+static boost::atomic<int> neuronCounter(0);
+
+/*!
+ * Give the Neuron a fresh ID
+ */
+int Neuron::newID() {
+	id = ++neuronCounter;
+	return id;
+}
+
+/*!
+ * Make sure no Neuron created from now on gets an ID up to last
+ * Used when Neurons with IDs from another run are brought back
+ */
+void Neuron::reserveIDs(int last) {
+	int current = neuronCounter.load();
+	while (current < last && !neuronCounter.compare_exchange_weak(current, last));
+}
+
+const TypeDescriptor Neuron::descriptor = { "basic neuron", 0 };
+static RegisterType registerNeuron(Neuron::descriptor);
+
+Neuron::Neuron(int size) : weight(size),
+						   fitness(0.0),
+						   trials(0),
 						   parent1(-1),
 						   parent2(-1),
+						   lesioned(false),
 						   tag(false),
-				    	   weight(size),
-						   trials(0),
-						   fitness(0.0) {
-	name = "basic neuron";
-	static int counter = 0;
-	id = ++counter;
+						   objectives(0) {
+	newID();
+}
+
+Neuron::Neuron(const Neuron& n) : weight(n.weight),
+								  fitness(n.fitness),
+								  trials(n.trials),
+								  id(n.id),
+								  parent1(n.parent1),
+								  parent2(n.parent2),
+								  lesioned(n.lesioned),
+								  tag(n.tag),
+								  objectives(n.objectives ? new std::vector<double>(*n.objectives) : 0) {
 }
 
-inline bool Neuron::checkBounds(int i) {
+Neuron::~Neuron() {
+	delete objectives;
+}
+
+bool Neuron::checkBounds(int i) {
 	if (i >= 0 && i < (int)weight.size()) {
 		return true;
 	} else {
@@ -64,15 +126,33 @@ void Neuron::addFitness(double fit) {
 	++trials;
 }
 
+/*!
+ * Add objective values to a Neuron
+ * Called with each trial's objectives before addFitness, which
+ * counts the trial
+ */
+void Neuron::addObjectives(const std::vector<double>& obj) {
+	if (!objectives) {
+		objectives = new std::vector<double>(obj.size(), 0.0);
+	} else if (objectives->size() != obj.size()) {
+		objectives->assign(obj.size(), 0.0);
+	}
+	for (unsigned int i = 0; i < obj.size(); ++i) {
+		(*objectives)[i] += obj[i];
+	}
+}
+
 /*!
  * Set a Neuron's fitness to zero
  */
 void Neuron::resetFitness() {
 	fitness = 0.0;
 	trials = 0;
+	delete objectives;
+	objectives = 0;
 }
 
-inline double Neuron::getFitness() {
+double Neuron::getFitness() {
 	if (trials) {
 		return fitness / (double)trials;
 	} else {
@@ -80,13 +160,34 @@ inline double Neuron::getFitness() {
 	}
 }
 
-inline void Neuron::setWeight(int i, double w) {
+/*!
+ * Average value of an objective over the trials
+ */
+double Neuron::getObjective(int i) {
+	if (i < 0 || i >= getNumObjectives()) {
+		std::cerr << "Objective index out of bounds; Neuron::getObjective" << std::endl;
+		abort();
+	}
+	return trials ? (*objectives)[i] / (double)trials : (*objectives)[i];
+}
+
+void Neuron::setWeight(int i, double w) {
 	if (checkBounds(i)) {
 		weight[i] = w;
 		newID();
 	}
 }
 
+/*!
+ * Reallocate the weights from the calling thread
+ * With first-touch NUMA placement the new storage is local to the
+ * node the caller runs on
+ */
+void Neuron::rehome() {
+	std::vector<double> local(weight.begin(), weight.end());
+	weight.swap(local);
+}
+
 /*!
  * Perturb the weights of a Neuron
  * Used to search in a neighbourhood around some Neuron (best)
@@ -98,17 +199,23 @@ void Neuron::perturb(const Neuron* n, double (*randFn)(double), double coeff) {
 	resetFitness();
 }
 
-void Neuron::perturb(const Neuron* n) {
-	perturb(n, rndCauchy, 0.3);
+/*!
+ * Cauchy perturbation drawn from rng
+ */
+void Neuron::perturb(const Neuron* n, double coeff, boost::mt19937& rng) {
+	for (int i = 0; i < weight.size(); ++i) {
+		setWeight(i, n->weight[i] + rndCauchy(coeff, rng));
+	}
+	resetFitness();
 }
 
 /*!
  * Same as above but called on self and returns new Neuron
  */
-Neuron* Neuron::perturb(double coeff) {
+Neuron* Neuron::perturb(double coeff, boost::mt19937& rng) {
 	Neuron* n = new Neuron(weight.size());
 	for (int i = 0; i < weight.size(); ++i) {
-		n->setWeight(i, weight[i] + rndCauchy(coeff));
+		n->setWeight(i, weight[i] + rndCauchy(coeff, rng));
 	}
 	return n;
 }
@@ -122,6 +229,10 @@ Neuron& Neuron::operator=(const Neuron &n) {
 	parent2 = n.parent2;
 	fitness = n.fitness;
 	trials = n.trials;
+	if (this != &n) {
+		delete objectives;
+		objectives = n.objectives ? new std::vector<double>(*n.objectives) : 0;
+	}
 	weight = n.weight;
 	return *this;
 }
@@ -153,35 +264,41 @@ bool Neuron::operator!=(Neuron& n) {
 /*!
  * Add a connection to a Neuron
  */
-inline void Neuron::addConnection(int n) {
+void Neuron::addConnection(int n) {
 	weight.insert(weight.begin() + n, 1.0);
+	newID();
 }
 
-inline void Neuron::removeConnection(int n) {
+void Neuron::removeConnection(int n) {
 	weight.erase(weight.begin() + n);
+	newID();
 }
 
 /*!
  * Creates a new set of random weights
  */
-void Neuron::create() {
-	boost::mt19937 rng(time(0));
+void Neuron::create(boost::mt19937& rng) {
 	boost::uniform_real<> dist(0.0, 12.0);
 	for (int i = 0; i < weight.size(); ++i) {
 		weight[i] = dist(rng) - 6.0; //change to Boost Random
 	}
+	newID();
 }
 
-void Neuron::mutate() {
-	boost::mt19937 rng(time(0));
+void Neuron::mutate(boost::mt19937& rng) {
 	boost::uniform_int<> dist(0, weight.size() - 1);
-	weight[dist(rng)] += rndCauchy(0.3);
+	weight[dist(rng)] += rndCauchy(0.3, rng);
+	newID();
 }
 
 Neuron* Neuron::crossoverOnePoint(Neuron& n) {
+	if (!isDense() || !n.isDense()) {
+		std::cerr << "Crossover of sparse Neurons; Neuron::crossoverOnePoint" << std::endl;
+		abort();
+	}
 	int s1 = weight.size();
 	std::vector<double>::iterator i, j, k;
-	boost::mt19937 rng(time(0));
+	boost::mt19937& rng = defaultRng();
 	boost::uniform_int<> dist(1, s1 - 1); // int cross1 = lrand48() % (s1 - 1) + 1
 	int cross1 = dist(rng);
 	Neuron* child = new Neuron(s1);
@@ -4,49 +4,88 @@
 #include <string>
 #include <ostream>
 #include <vector>
+#include "TypeDescriptor.hpp"
+#include <boost/random/mersenne_twister.hpp>
 
 namespace ESP {
 
+boost::mt19937& defaultRng();
+
+/*!
+ * Basic Neuron
+ * The data members are laid out with the fields used during
+ * evaluation and recombination first. Objective values are only
+ * allocated in multi-objective runs, and the name and type of the
+ * class live in its static TypeDescriptor. Every operation that
+ * changes the weights gives the Neuron a new ID, which is how
+ * DiversityMonitor finds the Neurons that changed. The random
+ * operators take the generator of the run that calls them; without
+ * one they use the generator of the calling thread
+ */
 class Neuron {
+protected:
+	std::vector<double> weight;
+	double fitness;
+	int trials;
+	int id;
 public:
+	int parent1;
+	int parent2;
 	bool lesioned;
+	bool tag;
+protected:
+	std::vector<double>* objectives;	///< Summed objective values, averaged over trials like fitness; 0 until used
+public:
+	static const TypeDescriptor descriptor;
 	Neuron(int);
+	Neuron(const Neuron&);
+	virtual ~Neuron();
 	virtual Neuron* clone() { return new Neuron( weight.size() );};
 	virtual Neuron& operator=(const Neuron&);
 	bool operator==(Neuron &);
 	bool operator!=(Neuron &);
-	virtual void create();
+	void create() { create(defaultRng()); };
+	virtual void create(boost::mt19937&);
 	virtual void addFitness(double);
+	void addObjectives(const std::vector<double>&);
 	virtual void resetFitness();
 	virtual void addConnection(int);
 	virtual void removeConnection(int);
-	void perturb(const Neuron *);
-	void perturb(const Neuron *, double (*randFn)(double), double);
-	Neuron* perturb(double coeff = 0.3);
-	virtual void mutate();
+	void perturb(const Neuron* n) { perturb(n, defaultRng()); };
+	void perturb(const Neuron* n, boost::mt19937& rng) { perturb(n, 0.3, rng); };
+	virtual void perturb(const Neuron *, double (*randFn)(double), double);
+	virtual void perturb(const Neuron *, double, boost::mt19937&);
+	Neuron* perturb(double coeff = 0.3) { return perturb(coeff, defaultRng()); };
+	virtual Neuron* perturb(double, boost::mt19937&);
+	void mutate() { mutate(defaultRng()); };
+	virtual void mutate(boost::mt19937&);
 	double getFitness();
+	double getObjective(int);
+	inline int getNumObjectives() { return objectives ? objectives->size() : 0; };
 	bool checkBounds(int);
 	inline unsigned int getSize() { return weight.size(); };
 	inline double getWeight(int i) { if( checkBounds(i) ) return weight[i]; else return -1.0; };
+	inline const double* getWeights() { return weight.empty() ? 0 : &weight[0]; };
 	void setWeight(int, double);
+	void rehome();
 	inline int getID() { return id; };
-	inline std::string getName() { return name; };
+	static void reserveIDs(int);
+	virtual const TypeDescriptor& getDescriptor() { return descriptor; };
+	inline std::string getName() { return getDescriptor().name; };
+	inline bool isDense() { return &getDescriptor() == &Neuron::descriptor; };	///< Whether weight is the full row, one weight per input and output
 	Neuron* crossoverOnePoint(Neuron &);
-	int parent1;
-	int parent2;
-	bool tag;
+	friend class NeuroEvolution;
+	friend class PopulationArchive;
+	friend class Refiner;
+	friend class ChampionBuffer;
 protected:
-	inline int newID() { Neuron n(0); id = n.getID(); return id; };
-	std::vector<double> weight;
-	int trials;
-	double fitness;
-	int id;
-	std::string name;
+	int newID();
 };
 
 }
 
 double rndCauchy(double);
+double rndCauchy(double, boost::mt19937&);
 
 std::ostream& operator<<(std::ostream &, ESP::Neuron &);
 
@@ -0,0 +1,290 @@
+#include "Novelty.hpp"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+namespace ESP {
+
+NoveltyArchive::NoveltyArchive(int d, int nn, double t, int leaf) : dim(d),
+																	 k(nn),
+																	 threshold(t),
+																	 leafSize(leaf),
+																	 indexed(0) {
+	if (dim <= 0 || k <= 0 || leafSize <= 0) {
+		std::cerr << "Dimension, k and leaf size must be positive; NoveltyArchive::NoveltyArchive" << std::endl;
+		abort();
+	}
+}
+
+void NoveltyArchive::check(unsigned int size) {
+	if (size == 0 || size % dim != 0) {
+		std::cerr << "Behavior of size " << size << " in archive of dimension " << dim << "; NoveltyArchive::check" << std::endl;
+		abort();
+	}
+}
+
+/*!
+ * Mean distance of a k-nearest heap of squared distances
+ */
+static double meanDistance(const std::vector<double>& heap) {
+	double sum = 0.0;
+	for (unsigned int i = 0; i < heap.size(); ++i) {
+		sum += sqrt(heap[i]);
+	}
+	return sum / heap.size();
+}
+
+/*!
+ * Novelty fitness of a behavior
+ * Computes the novelty of the behavior and adds it to the archive
+ * if it is above the threshold. Used by Environment::evaluateNetwork
+ */
+double NoveltyArchive::evaluate(const std::vector<double>& behavior) {
+	check(behavior.size());
+	boost::mutex::scoped_lock lock(mutex);
+	double nov = points.empty() ? threshold : query(&behavior[0]);
+	if (nov >= threshold) {
+		points.insert(points.end(), behavior.begin(), behavior.begin() + dim);
+		if (size() - indexed > indexed / 2 + leafSize) {
+			rebuild();
+		}
+	}
+	return nov;
+}
+
+/*!
+ * Novelty of a behavior without archiving it
+ */
+double NoveltyArchive::novelty(const std::vector<double>& behavior) {
+	check(behavior.size());
+	boost::mutex::scoped_lock lock(mutex);
+	return points.empty() ? threshold : query(&behavior[0]);
+}
+
+/*!
+ * Novelty of a batch of behaviors stored row-major
+ * Gives the same result as querying the behaviors one at a time, but
+ * walks the KD-tree once for the whole batch, see searchBatch
+ */
+void NoveltyArchive::novelty(const std::vector<double>& behaviors, std::vector<double>& result) {
+	check(behaviors.size());
+	boost::mutex::scoped_lock lock(mutex);
+	int n = behaviors.size() / dim;
+	result.assign(n, threshold);
+	if (points.empty()) {
+		return;
+	}
+	std::vector<std::vector<double> > heaps(n);
+	std::vector<int> active(n);
+	for (int i = 0; i < n; ++i) {
+		heaps[i].reserve(k + 1);
+		active[i] = i;
+	}
+	if (!nodes.empty()) {
+		searchBatch(0, &behaviors[0], &active[0], &active[0] + n, heaps);
+	}
+	for (int i = 0; i < n; ++i) {
+		scan(&behaviors[i * dim], &points[0] + indexed * dim, &points[0] + points.size(), heaps[i]);
+		result[i] = meanDistance(heaps[i]);
+	}
+}
+
+/*!
+ * Add a behavior to the archive regardless of its novelty
+ */
+void NoveltyArchive::insert(const std::vector<double>& behavior) {
+	check(behavior.size());
+	boost::mutex::scoped_lock lock(mutex);
+	points.insert(points.end(), behavior.begin(), behavior.begin() + dim);
+	if (size() - indexed > indexed / 2 + leafSize) {
+		rebuild();
+	}
+}
+
+/*!
+ * Mean distance to the k nearest archived behaviors
+ */
+double NoveltyArchive::query(const double* q) {
+	std::vector<double> heap;
+	heap.reserve(k + 1);
+	if (!nodes.empty()) {
+		search(0, q, heap);
+	}
+	scan(q, &points[0] + indexed * dim, &points[0] + points.size(), heap);
+	return meanDistance(heap);
+}
+
+/*!
+ * Offer a contiguous block of points to the k-nearest heap
+ * The squared distances of the whole block are computed first, in a
+ * loop with no branches, and only then merged into the heap
+ */
+void NoveltyArchive::scan(const double* q, const double* begin, const double* end, std::vector<double>& heap) {
+	int n = (end - begin) / dim;
+	double dist[64];
+	for (int b = 0; b < n; b += 64) {
+		int m = std::min(64, n - b);
+		const double* p = begin + b * dim;
+		for (int i = 0; i < m; ++i) {
+			double sum = 0.0;
+			for (int d = 0; d < dim; ++d) {
+				double diff = q[d] - p[i * dim + d];
+				sum += diff * diff;
+			}
+			dist[i] = sum;
+		}
+		for (int i = 0; i < m; ++i) {
+			if ((int)heap.size() < k) {
+				heap.push_back(dist[i]);
+				std::push_heap(heap.begin(), heap.end());
+			} else if (dist[i] < heap.front()) {
+				std::pop_heap(heap.begin(), heap.end());
+				heap.back() = dist[i];
+				std::push_heap(heap.begin(), heap.end());
+			}
+		}
+	}
+}
+
+void NoveltyArchive::search(int n, const double* q, std::vector<double>& heap) {
+	const Node& node = nodes[n];
+	if (node.split < 0) {
+		scan(q, &tree[0] + node.begin * dim, &tree[0] + node.end * dim, heap);
+		return;
+	}
+	double diff = q[node.split] - node.value;
+	int nearer = diff < 0.0 ? node.left : node.right;
+	int further = diff < 0.0 ? node.right : node.left;
+	search(nearer, q, heap);
+	if ((int)heap.size() < k || diff * diff < heap.front()) {
+		search(further, q, heap);
+	}
+}
+
+/*!
+ * Whether a query lies below the splitting value of a node
+ */
+struct Below {
+	const double* queries;
+	int dim;
+	int axis;
+	double value;
+	bool operator()(int q) const { return queries[q * dim + axis] < value; }
+};
+
+/*!
+ * Whether a query must also visit the far side of a node
+ */
+struct Reaches {
+	const double* queries;
+	const std::vector<std::vector<double> >* heaps;
+	int dim;
+	int k;
+	int axis;
+	double value;
+	bool operator()(int q) const {
+		const std::vector<double>& heap = (*heaps)[q];
+		double diff = queries[q * dim + axis] - value;
+		return (int)heap.size() < k || diff * diff < heap.front();
+	}
+};
+
+/*!
+ * Search the subtree of node n for the queries listed in [begin, end)
+ * The list is partitioned in place by the side each query visits
+ * first; both halves descend, and then the queries whose heaps show
+ * that the far side can still hold a nearer point descend there. So
+ * every query visits the nodes search would, nearer side first, and
+ * a leaf is scanned for all its queries in a row
+ */
+void NoveltyArchive::searchBatch(int n, const double* queries, int* begin, int* end, std::vector<std::vector<double> >& heaps) {
+	if (begin == end) {
+		return;
+	}
+	const Node& node = nodes[n];
+	if (node.split < 0) {
+		const double* first = &tree[0] + node.begin * dim;
+		const double* last = &tree[0] + node.end * dim;
+		for (int* q = begin; q != end; ++q) {
+			scan(queries + *q * dim, first, last, heaps[*q]);
+		}
+		return;
+	}
+	Below below = { queries, dim, node.split, node.value };
+	int* mid = std::partition(begin, end, below);
+	searchBatch(node.left, queries, begin, mid, heaps);
+	searchBatch(node.right, queries, mid, end, heaps);
+	Reaches reaches = { queries, &heaps, dim, k, node.split, node.value };
+	searchBatch(node.right, queries, begin, std::partition(begin, mid, reaches), heaps);
+	searchBatch(node.left, queries, mid, std::partition(mid, end, reaches), heaps);
+}
+
+/*!
+ * Rebuild the KD-tree over all the archived behaviors
+ */
+void NoveltyArchive::rebuild() {
+	int n = size();
+	std::vector<int> idx(n);
+	for (int i = 0; i < n; ++i) {
+		idx[i] = i;
+	}
+	nodes.clear();
+	build(idx, 0, n);
+	tree.resize(points.size());
+	for (int i = 0; i < n; ++i) {
+		std::copy(&points[idx[i] * dim], &points[idx[i] * dim] + dim, &tree[i * dim]);
+	}
+	indexed = n;
+}
+
+struct CompareAxis {
+	const std::vector<double>* points;
+	int dim;
+	int axis;
+	bool operator()(int a, int b) const { return (*points)[a * dim + axis] < (*points)[b * dim + axis]; }
+};
+
+/*!
+ * Build the subtree over idx[begin, end)
+ * Splits on the dimension of largest spread at the median
+ */
+int NoveltyArchive::build(std::vector<int>& idx, int begin, int end) {
+	int n = nodes.size();
+	nodes.push_back(Node());
+	nodes[n].split = -1;
+	nodes[n].begin = begin;
+	nodes[n].end = end;
+	if (end - begin <= leafSize) {
+		return n;
+	}
+	int axis = 0;
+	double spread = -1.0;
+	for (int d = 0; d < dim; ++d) {
+		double lo = points[idx[begin] * dim + d], hi = lo;
+		for (int i = begin + 1; i < end; ++i) {
+			double v = points[idx[i] * dim + d];
+			lo = std::min(lo, v);
+			hi = std::max(hi, v);
+		}
+		if (hi - lo > spread) {
+			spread = hi - lo;
+			axis = d;
+		}
+	}
+	if (spread <= 0.0) {
+		return n;
+	}
+	int mid = (begin + end) / 2;
+	CompareAxis cmp = { &points, dim, axis };
+	std::nth_element(idx.begin() + begin, idx.begin() + mid, idx.begin() + end, cmp);
+	nodes[n].split = axis;
+	nodes[n].value = points[idx[mid] * dim + axis];
+	int left = build(idx, begin, mid);
+	int right = build(idx, mid, end);
+	nodes[n].left = left;
+	nodes[n].right = right;
+	return n;
+}
+
+}
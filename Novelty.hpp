@@ -0,0 +1,59 @@
+#ifndef _NOVELTY_HPP_
+#define _NOVELTY_HPP_
+
+#include <vector>
+#include <boost/thread/mutex.hpp>
+
+namespace ESP {
+
+/*!
+ * Archive of behavior descriptors for novelty search
+ * The novelty of a behavior is the mean distance to its k nearest
+ * neighbours in the archive. Archived behaviors are indexed by a
+ * KD-tree whose leaves are stored contiguously, so a query only
+ * scans a few small blocks of points. A batch of behaviors goes
+ * down the tree together, so each leaf block is loaded once for all
+ * the queries that reach it. Behaviors added since the last rebuild
+ * are scanned linearly until the tree is rebuilt
+ */
+class NoveltyArchive {
+public:
+	NoveltyArchive(int, int k = 15, double threshold = 1.0, int leafSize = 16);
+	double evaluate(const std::vector<double>&);
+	double novelty(const std::vector<double>&);
+	void novelty(const std::vector<double>&, std::vector<double>&);
+	void insert(const std::vector<double>&);
+	inline unsigned int size() { return points.size() / dim; };
+	inline int getDimension() { return dim; };
+	inline double getThreshold() { return threshold; };
+	inline void setThreshold(double t) { threshold = t; };
+private:
+	struct Node {
+		int split;			///< Splitting dimension, -1 for a leaf
+		double value;		///< Splitting value
+		int left;
+		int right;
+		int begin;			///< First point of a leaf in tree
+		int end;
+	};
+	int dim;
+	int k;
+	double threshold;		///< Minimum novelty for a behavior to be archived
+	int leafSize;
+	std::vector<double> points;	///< All archived behaviors, row-major
+	std::vector<double> tree;	///< Indexed behaviors in leaf order, row-major
+	std::vector<Node> nodes;
+	unsigned int indexed;		///< Number of behaviors in the tree
+	boost::mutex mutex;
+	void check(unsigned int);
+	void rebuild();
+	int build(std::vector<int>&, int, int);
+	void search(int, const double*, std::vector<double>&);
+	void searchBatch(int, const double*, int*, int*, std::vector<std::vector<double> >&);
+	void scan(const double*, const double*, const double*, std::vector<double>&);
+	double query(const double*);
+};
+
+}
+
+#endif
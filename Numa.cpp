@@ -0,0 +1,184 @@
+#include "Numa.hpp"
+#include "Neuron.hpp"
+#include "Network.hpp"
+#include "Environment.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <boost/bind/bind.hpp>
+#include <boost/thread/thread.hpp>
+#ifdef ESP_NUMA
+#include <numa.h>
+#endif
+
+namespace ESP {
+
+/*!
+ * Pin the calling worker to a node
+ * Also makes the node the preferred source of the worker's memory
+ */
+static void bindToNode(int node) {
+#ifdef ESP_NUMA
+	numa_run_on_node(node);
+	numa_set_preferred(node);
+#endif
+}
+
+NumaExecutor::NumaExecutor(int threadsPerNode) {
+	int nodes = 1;
+	int cpus = boost::thread::hardware_concurrency();
+#ifdef ESP_NUMA
+	if (numa_available() >= 0) {
+		nodes = numa_max_node() + 1;
+		cpus = numa_num_configured_cpus();
+	}
+#endif
+	int threads = threadsPerNode > 0 ? threadsPerNode : std::max(1, cpus / nodes);
+	for (int n = 0; n < nodes; ++n) {
+		pools.push_back(new Executor(threads, boost::bind(bindToNode, n)));
+	}
+}
+
+NumaExecutor::~NumaExecutor() {
+	for (unsigned int i = 0; i < pools.size(); ++i) {
+		delete pools[i];
+	}
+}
+
+void NumaExecutor::submit(int node, boost::function<void()> task) {
+	pools[node]->submitShared(task);
+}
+
+/*!
+ * Wait for the tasks of every node
+ */
+void NumaExecutor::wait() {
+	for (unsigned int i = 0; i < pools.size(); ++i) {
+		pools[i]->wait();
+	}
+}
+
+static void createSubpop(NeuronPop* pop) {
+	pop->create();
+}
+
+static void createSeededSubpop(NeuronPop* pop, unsigned int seed) {
+	boost::mt19937 rng(seed);
+	pop->create(rng);
+}
+
+static void placeSubpop(NeuronPop* pop) {
+	for (unsigned int i = 0; i < pop->getNumIndividuals(); ++i) {
+		pop->getIndividual(i)->rehome();
+	}
+}
+
+static void applyToSubpop(boost::function<void(NeuronPop&)> fn, NeuronPop* pop) {
+	fn(*pop);
+}
+
+/*!
+ * Create the subpopulations on their nodes
+ */
+void NumaExecutor::create(std::vector<NeuronPop*>& subpops) {
+	for (unsigned int i = 0; i < subpops.size(); ++i) {
+		submit(getNode(i), boost::bind(createSubpop, subpops[i]));
+	}
+	wait();
+}
+
+/*!
+ * Create the subpopulations on their nodes from the run's generator
+ * Every subpopulation gets its own stream, seeded from rng in order,
+ * so the result does not depend on which worker creates it
+ */
+void NumaExecutor::create(std::vector<NeuronPop*>& subpops, boost::mt19937& rng) {
+	for (unsigned int i = 0; i < subpops.size(); ++i) {
+		submit(getNode(i), boost::bind(createSeededSubpop, subpops[i], (unsigned int)rng()));
+	}
+	wait();
+}
+
+/*!
+ * Move the weights of existing subpopulations to their nodes
+ * Used after loading or promoting subpopulations created elsewhere
+ */
+void NumaExecutor::place(std::vector<NeuronPop*>& subpops) {
+	for (unsigned int i = 0; i < subpops.size(); ++i) {
+		submit(getNode(i), boost::bind(placeSubpop, subpops[i]));
+	}
+	wait();
+}
+
+/*!
+ * Run fn on every subpopulation on that subpopulation's node
+ * Used for recombination and mutation, which only touch the
+ * subpopulation's own Neurons
+ */
+void NumaExecutor::forEachSubpop(std::vector<NeuronPop*>& subpops, boost::function<void(NeuronPop&)> fn) {
+	for (unsigned int i = 0; i < subpops.size(); ++i) {
+		submit(getNode(i), boost::bind(applyToSubpop, fn, subpops[i]));
+	}
+	wait();
+}
+
+static void allocateNetworks(std::vector<Network*>* nets, Network* exemplar, int node, int nodes) {
+	for (unsigned int k = node; k < nets->size(); k += nodes) {
+		(*nets)[k] = exemplar->clone();
+	}
+}
+
+/*!
+ * Allocate count uncreated copies of exemplar
+ * Network k is allocated by a worker of node k % getNumNodes(), so
+ * its activation and Neuron pointers live in that node's memory.
+ * The Networks are then filled with Neurons with setNeuron
+ */
+void NumaExecutor::allocate(std::vector<Network*>& nets, Network& exemplar, int count) {
+	nets.assign(count, 0);
+	int nodes = getNumNodes();
+	for (int n = 0; n < nodes; ++n) {
+		submit(n, boost::bind(allocateNetworks, &nets, &exemplar, n, nodes));
+	}
+	wait();
+}
+
+/*!
+ * Evaluate Networks of one node with one of its Environments
+ * Takes every stride-th Network starting at first and moves its
+ * weights to the node first
+ */
+static void evaluateNetworks(std::vector<Network*>* nets, Environment* envt, int first, int stride) {
+	for (unsigned int k = first; k < nets->size(); k += stride) {
+		(*nets)[k]->rehome();
+		envt->evaluateEpisodes((*nets)[k]);
+	}
+}
+
+/*!
+ * Evaluate Network k on node k % getNumNodes()
+ * envts[n] holds the Environments of node n, one per concurrent
+ * evaluation; each Environment is used by one task at a time. The
+ * Environments can share one NeuroEvolution, whose evaluation
+ * counters are atomic; every Network is then evaluated on its
+ * common episodes
+ */
+void NumaExecutor::evaluate(std::vector<Network*>& nets, std::vector<std::vector<Environment*> >& envts) {
+	int nodes = getNumNodes();
+	if ((int)envts.size() != nodes) {
+		std::cerr << "One set of Environments per node expected; NumaExecutor::evaluate" << std::endl;
+		abort();
+	}
+	for (int n = 0; n < nodes; ++n) {
+		int workers = envts[n].size();
+		if (workers == 0) {
+			std::cerr << "Node " << n << " has no Environment; NumaExecutor::evaluate" << std::endl;
+			abort();
+		}
+		for (int w = 0; w < workers; ++w) {
+			submit(n, boost::bind(evaluateNetworks, &nets, envts[n][w], n + w * nodes, nodes * workers));
+		}
+	}
+	wait();
+}
+
+}
@@ -0,0 +1,53 @@
+#ifndef _NUMA_HPP_
+#define _NUMA_HPP_
+
+#include "Population.hpp"
+#include "Executor.hpp"
+#include <vector>
+#include <boost/function.hpp>
+
+namespace ESP {
+
+class Network;
+class Environment;
+
+/*!
+ * NUMA-aware execution of ESP
+ * Runs one Executor per NUMA node with its workers pinned to the
+ * node, and maps subpopulation i to node i % getNumNodes(). The
+ * weights of a subpopulation are allocated by workers of its node,
+ * so first-touch places them in node-local memory, and the work on a
+ * subpopulation is routed to the same node. Networks are handled
+ * the same way: Network k is allocated by a worker of node
+ * k % getNumNodes() and is always evaluated there, with that node's
+ * Environments. Before an evaluation the Network is rehomed, which
+ * for a FeedForwardNetwork copies the weights of its Neurons, spread
+ * over the nodes of their subpopulations, into packed blocks on the
+ * evaluating node; Networks that activate straight from their
+ * Neurons keep reading remote weights. Built with make NUMA=1,
+ * which defines ESP_NUMA and links -lnuma, the topology comes from
+ * libnuma; otherwise, or if the machine has no NUMA support, all
+ * the CPUs form a single node
+ */
+class NumaExecutor {
+public:
+	NumaExecutor(int threadsPerNode = 0);
+	~NumaExecutor();
+	inline int getNumNodes() { return pools.size(); };
+	inline int getNode(int subpop) { return subpop % pools.size(); };
+	inline Executor& getPool(int node) { return *pools[node]; };
+	void submit(int, boost::function<void()>);
+	void wait();
+	void create(std::vector<NeuronPop*>&);
+	void create(std::vector<NeuronPop*>&, boost::mt19937&);
+	void place(std::vector<NeuronPop*>&);
+	void forEachSubpop(std::vector<NeuronPop*>&, boost::function<void(NeuronPop&)>);
+	void allocate(std::vector<Network*>&, Network&, int);
+	void evaluate(std::vector<Network*>&, std::vector<std::vector<Environment*> >&);
+private:
+	std::vector<Executor*> pools;
+};
+
+}
+
+#endif
@@ -26,12 +26,12 @@ Population<T>::~Population() {
  * Creates the random Population and set the member created to true.
  */
 template<typename T>
-void Population<T>::create() {
+void Population<T>::create(boost::mt19937& rng) {
 	if (!created) {
 		if (evolvable) {
 			for (unsigned int i = 0; i < individuals.size(); ++i) {
 				individuals[i] = exemplar.clone();
-				individuals[i]->create();
+				individuals[i]->create(rng);
 			}
 			created = true;
 		}
@@ -56,6 +56,25 @@ void Population<T>::destroyIndividuals() {
 	created = false;
 }
 
+/*!
+ * Replace the individuals of the Population
+ * The current individuals are destroyed and the Population
+ * takes ownership of the new ones
+ */
+template<typename T>
+void Population<T>::setIndividuals(std::vector<T*>& ind) {
+	destroyIndividuals();
+	individuals = ind;
+	created = !individuals.empty();
+	maxID = 0;
+	for (unsigned int i = 0; i < individuals.size(); ++i) {
+		if (individuals[i]->getID() > maxID) {
+			maxID = individuals[i]->getID();
+		}
+	}
+	bestIndividual = created ? individuals.front() : 0;
+}
+
 template<typename T>
 T* Population<T>::operator[](int i) {
 	if ((i >= 0) && (i < individuals.size())) {
@@ -71,16 +90,17 @@ T* Population<T>::operator[](int i) {
  */
 template <typename T>
 void Population<T>::evalReset() {
-	mapv(typename &T::resetFitness);
+	mapv(&T::resetFitness);
 }
 
 /*!
  * Select an individual at random
+ * Picks among the first i individuals, or the whole Population
+ * if i is out of range
  */
 template <typename T>
-T* Population<T>::selectRndIndividual(int i) {
-	boost::mt19937 rng(time(0));
-	boost::uniform_int<> dist(0, (i > 0 && i < individuals.size()) ? i : individuals.size());
+T* Population<T>::selectRndIndividual(int i, boost::mt19937& rng) {
+	boost::uniform_int<> dist(0, ((i > 0 && i < (int)individuals.size()) ? i : individuals.size()) - 1);
 	return individuals[dist(rng)];
 }
 
@@ -93,16 +113,25 @@ void Population<T>::qsortIndividuals() {
 	bestIndividual = individuals.front();
 }
 
+/*!
+ * Sort the individuals by non-dominated front and crowding distance
+ * Multi-objective counterpart of qsortIndividuals
+ */
+template <typename T>
+void Population<T>::nsgaSortIndividuals() {
+	nsgaSort(individuals);
+	bestIndividual = individuals.front();
+}
+
 /*!
  * Mutate half of the Neurons with Cauchy noise
  */
 template <typename T>
-void Population<T>::mutate(double mutrate) {
-	boost::mt19937 rng(time(0));
+void Population<T>::mutate(double mutrate, boost::mt19937& rng) {
 	boost::uniform_real<> dist(0.0, 1.0);
 	for (int i = numBreed * 2; i < individuals.size(); ++i) {
 		if (dist(rng) < mutrate) {
-			individuals[i]->mutate();
+			individuals[i]->mutate(rng);
 		}
 	}
 }
@@ -110,13 +139,20 @@ void Population<T>::mutate(double mutrate) {
 /*! 
  * Used to perform "delta coding" like burst mutation
  * Make each Neuron a perturbation of the Neuron in
- * the best Network that corresponds to that subIndividuals
+ * the best Network that corresponds to that subIndividuals.
+ * best is usually one of the individuals, so the others are
+ * perturbed around a copy of it and best itself is kept as it is
  */
 template <typename T>
-void Population<T>::deltify(T* best) {
+void Population<T>::deltify(T* best, boost::mt19937& rng) {
+	T* center = best->clone();
+	*center = *best;
 	for (int i = 0; i < individuals.size(); ++i) {
-		individuals[i]->perturb(best);
+		if (individuals[i] != best) {
+			individuals[i]->perturb(center, rng);
+		}
 	}
+	delete center;
 }
 
 /*!
@@ -143,6 +179,21 @@ void Population<T>::pushIndividual(T* n) {
 	individuals.push_back(n);
 }
 
+/*!
+ * Fitness of the worst individual that breeds
+ * Only meaningful after qsortIndividuals.  Used as the race cutoff
+ * for the evaluations of the next generation, see
+ * NeuroEvolution::setRaceCutoff
+ */
+template <typename T>
+double Population<T>::getBreedCutoff() {
+	if (individuals.empty()) {
+		return 0.0;
+	}
+	unsigned int i = std::min(numBreed, (unsigned int)individuals.size());
+	return individuals[i > 0 ? i - 1 : 0]->getFitness();
+}
+
 template <typename T>
 double Population<T>::getAverageFitness() {
 	double sum = 0;
@@ -155,7 +206,7 @@ double Population<T>::getAverageFitness() {
 }
 
 template <typename T>
-ostream& operator<<(ostream& os, ESP::Population<T>& p) {
+std::ostream& operator<<(std::ostream& os, ESP::Population<T>& p) {
 	for (int i = 0; i < p.getNumIndividuals(); ++i) {
 		os << *p.getNumIndividual(i) << std::endl;
 	}
@@ -2,6 +2,7 @@
 #define _POPULATION_HPP_
 
 #include "Network.hpp"
+#include "MultiObjective.hpp"
 #include <typeinfo>
 #include <cstdio>
 #include <vector>
@@ -17,31 +18,38 @@ class Population {
 public:
 	Population(int, T&);
 	~Population();
-	void create();
+	void create() { create(defaultRng()); };
+	void create(boost::mt19937&);
 	struct max_fit : public std::binary_function<T*, T*, bool> {
 		bool operator()(T* x, T* y) { return x->getFitness() > y->getFitness(); }
 	};
 	void destroyIndividuals();
+	void setIndividuals(std::vector<T*>&);
 	void map(double (*map_fn)(T*)) {
 		for (typename std::vector<T*>::iterator i = individuals.begin(); i != individuals.end(); ++i) {
 			map_fn(i);
 		}
 	}
-	void mapv(void (typename T::*map_fn)()) {
+	void mapv(void (T::*map_fn)()) {
 		for (typename std::vector<T*>::iterator i = individuals.begin(); i != individuals.end(); ++i) {
 			(*i->*map_fn)();
 		}
 	}
 	T* operator[](int i);
 	void evalReset();
-	T* selectRndIndividual(int i = -1);
+	T* selectRndIndividual(int i = -1) { return selectRndIndividual(i, defaultRng()); };
+	T* selectRndIndividual(int, boost::mt19937&);
 	void average();
 	void qsortIndividuals();
-	void mutate(double);
-	void deltify(T*);
+	void nsgaSortIndividuals();
+	void mutate(double mutrate) { mutate(mutrate, defaultRng()); };
+	void mutate(double, boost::mt19937&);
+	void deltify(T* best) { deltify(best, defaultRng()); };
+	void deltify(T*, boost::mt19937&);
 	void popIndividual();
-	void pushIndividual();
-	double getAverageFitness(T*);
+	void pushIndividual(T*);
+	double getAverageFitness();
+	double getBreedCutoff();
 	inline unsigned int getNumIndividuals() { return individuals.size(); };
 	inline T* getIndividual(int i) { return individuals[i]; };
 	inline unsigned int getNumBreed() { return numBreed; };
@@ -0,0 +1,170 @@
+#include "Quantized.hpp"
+#include "FeedForward.hpp"
+#include "Neuron.hpp"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <boost/thread/once.hpp>
+
+namespace ESP {
+
+const double QuantizedNetwork::TABLE_RANGE = 8.0;
+boost::uint16_t QuantizedNetwork::table[QuantizedNetwork::TABLE_SIZE];
+
+static boost::once_flag tableOnce = BOOST_ONCE_INIT;
+
+/*!
+ * Fill the sigmoid table
+ * Entry i holds sigmoid(x) in Q16 for x at the centre of bucket i
+ */
+void QuantizedNetwork::fillTable() {
+	for (int i = 0; i < TABLE_SIZE; ++i) {
+		double x = ((i + 0.5) / TABLE_SIZE * 2.0 - 1.0) * TABLE_RANGE;
+		table[i] = (boost::uint16_t)floor(65535.0 / (1.0 + exp(-x)) + 0.5);
+	}
+}
+
+/*!
+ * Fill the sigmoid table once, even when Networks are quantized
+ * from several threads at the same time
+ */
+void QuantizedNetwork::initTable() {
+	boost::call_once(&QuantizedNetwork::fillTable, tableOnce);
+}
+
+/*!
+ * Sigmoid of an integer accumulator
+ * mult maps the accumulator to table buckets in Q16
+ */
+inline boost::uint16_t QuantizedNetwork::lookup(boost::int64_t acc, boost::int64_t mult) {
+	boost::int64_t i = ((acc * mult) >> 16) + TABLE_SIZE / 2;
+	if (i < 0) {
+		i = 0;
+	} else if (i >= TABLE_SIZE) {
+		i = TABLE_SIZE - 1;
+	}
+	return table[i];
+}
+
+/*!
+ * Quantize a 1 x n row of weights to int8
+ * Returns the size of one quantization step
+ */
+static double quantizeRow(const std::vector<double>& w, boost::int8_t* q) {
+	double range = 0.0;
+	for (unsigned int i = 0; i < w.size(); ++i) {
+		range = std::max(range, fabs(w[i]));
+	}
+	double step = range > 0.0 ? range / 127.0 : 1.0;
+	for (unsigned int i = 0; i < w.size(); ++i) {
+		q[i] = (boost::int8_t)floor(w[i] / step + 0.5);
+	}
+	return step;
+}
+
+QuantizedNetwork::QuantizedNetwork(Network* net, double inputRange) : numInputs(net->numInputs),
+																	  numHidden(net->getNumNeurons()),
+																	  numOutputs(net->numOutputs),
+																	  inputScale(inputRange / 127.0),
+																	  hiddenWeights(numHidden * numInputs),
+																	  hiddenMult(numHidden),
+																	  outputWeights(numOutputs * numHidden),
+																	  outputMult(numOutputs),
+																	  qinput(numInputs),
+																	  hidden(numHidden) {
+	if (&net->getDescriptor() != &FeedForwardNetwork::descriptor) {
+		std::cerr << "Cannot quantize a " << net->getName() << "; QuantizedNetwork::QuantizedNetwork" << std::endl;
+		abort();
+	}
+	initTable();
+	const double bucket = TABLE_SIZE / (2.0 * TABLE_RANGE);
+	std::vector<double> row(numInputs);
+	std::vector<std::vector<double> > out(numOutputs, std::vector<double>(numHidden));
+	for (int i = 0; i < numHidden; ++i) {
+		Neuron* n = net->getNeuron(i);
+		if (!n->isDense()) {
+			std::cerr << "Neuron " << i << " is sparse; QuantizedNetwork::QuantizedNetwork" << std::endl;
+			abort();
+		}
+		if ((int)n->getSize() < numInputs + numOutputs) {
+			std::cerr << "Neuron has " << n->getSize() << " weights, expected " << numInputs + numOutputs << "; QuantizedNetwork::QuantizedNetwork" << std::endl;
+			abort();
+		}
+		for (int j = 0; j < numInputs; ++j) {
+			row[j] = n->lesioned ? 0.0 : n->getWeight(j);
+		}
+		for (int j = 0; j < numOutputs; ++j) {
+			out[j][i] = n->lesioned ? 0.0 : n->getWeight(numInputs + j);
+		}
+		double step = quantizeRow(row, &hiddenWeights[i * numInputs]);
+		hiddenMult[i] = (boost::int64_t)floor(inputScale * step * bucket * 65536.0 + 0.5);
+	}
+	for (int j = 0; j < numOutputs; ++j) {
+		double step = quantizeRow(out[j], &outputWeights[j * numHidden]);
+		outputMult[j] = (boost::int64_t)floor(step / 255.0 * bucket * 65536.0 + 0.5);
+	}
+}
+
+/*!
+ * Activate the quantized Network
+ */
+void QuantizedNetwork::activate(const double* input, double* output) {
+	const double inv = 1.0 / inputScale;
+	for (int j = 0; j < numInputs; ++j) {
+		double x = floor(input[j] * inv + 0.5);
+		qinput[j] = (boost::int8_t)std::max(-127.0, std::min(127.0, x));
+	}
+	const boost::int8_t* x = &qinput[0];
+	for (int i = 0; i < numHidden; ++i) {
+		const boost::int8_t* w = &hiddenWeights[i * numInputs];
+		boost::int32_t acc = 0;
+		for (int j = 0; j < numInputs; ++j) {
+			acc += (boost::int32_t)w[j] * (boost::int32_t)x[j];
+		}
+		hidden[i] = lookup(acc, hiddenMult[i]) >> 8;
+	}
+	const boost::uint8_t* h = &hidden[0];
+	for (int j = 0; j < numOutputs; ++j) {
+		const boost::int8_t* w = &outputWeights[j * numHidden];
+		boost::int32_t acc = 0;
+		for (int i = 0; i < numHidden; ++i) {
+			acc += (boost::int32_t)w[i] * (boost::int32_t)h[i];
+		}
+		output[j] = lookup(acc, outputMult[j]) / 65535.0;
+	}
+}
+
+void QuantizedNetwork::activate(const std::vector<double>& input, std::vector<double>& output) {
+	output.resize(numOutputs);
+	activate(&input[0], &output[0]);
+}
+
+/*!
+ * Memory used by the weights and multipliers, in bytes
+ */
+unsigned int QuantizedNetwork::getFootprint() {
+	return hiddenWeights.size() + outputWeights.size() + (hiddenMult.size() + outputMult.size()) * sizeof(boost::int64_t);
+}
+
+/*!
+ * Accuracy check against the original Network
+ * Activates both Networks on every sample and returns the largest
+ * absolute difference between their outputs
+ */
+double QuantizedNetwork::maxError(Network* net, QuantizedNetwork& q, const std::vector<std::vector<double> >& samples) {
+	std::vector<double> in, out(net->numOutputs), qout;
+	double err = 0.0;
+	for (unsigned int s = 0; s < samples.size(); ++s) {
+		in = samples[s];
+		net->resetActivation();
+		net->activate(in, out);
+		q.activate(samples[s], qout);
+		for (int j = 0; j < net->numOutputs; ++j) {
+			err = std::max(err, fabs(out[j] - qout[j]));
+		}
+	}
+	return err;
+}
+
+}
@@ -0,0 +1,54 @@
+#ifndef _QUANTIZED_HPP_
+#define _QUANTIZED_HPP_
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+namespace ESP {
+
+class Network;
+
+/*!
+ * Fixed-point copy of a trained feed-forward Network for deployment
+ * Each hidden Neuron holds numInputs input weights followed by
+ * numOutputs output weights, and hidden and output units use the
+ * logistic sigmoid, as in Network::sigmoid. Weights are stored as
+ * int8 with one scale per hidden and per output unit, inputs are
+ * quantized to int8 over [-inputRange, inputRange] and hidden
+ * activations to uint8, so every dot product is an integer kernel.
+ * The sigmoid is a lookup table indexed by a fixed-point rescaling
+ * of the integer accumulator. Only FeedForwardNetworks can be
+ * quantized. activate uses internal buffers and must not be called
+ * concurrently on the same object
+ */
+class QuantizedNetwork {
+public:
+	QuantizedNetwork(Network*, double inputRange = 1.0);
+	void activate(const double*, double*);
+	void activate(const std::vector<double>&, std::vector<double>&);
+	unsigned int getFootprint();
+	inline int getNumInputs() { return numInputs; };
+	inline int getNumOutputs() { return numOutputs; };
+	static double maxError(Network*, QuantizedNetwork&, const std::vector<std::vector<double> >&);
+private:
+	int numInputs;
+	int numHidden;
+	int numOutputs;
+	double inputScale;						///< Input units per quantization step
+	std::vector<boost::int8_t> hiddenWeights;	///< numHidden x numInputs, row-major
+	std::vector<boost::int64_t> hiddenMult;	///< Accumulator to table index multipliers, Q16
+	std::vector<boost::int8_t> outputWeights;	///< numOutputs x numHidden, row-major
+	std::vector<boost::int64_t> outputMult;
+	std::vector<boost::int8_t> qinput;
+	std::vector<boost::uint8_t> hidden;
+	static const int TABLE_SIZE = 4096;
+	static const double TABLE_RANGE;		///< The table covers [-TABLE_RANGE, TABLE_RANGE)
+	static boost::uint16_t table[TABLE_SIZE];
+	static void initTable();
+	static void fillTable();
+	static inline boost::uint16_t lookup(boost::int64_t, boost::int64_t);
+};
+
+}
+
+#endif
@@ -0,0 +1,168 @@
+#include "Refine.hpp"
+#include "Network.hpp"
+#include "Neuron.hpp"
+#include "Environment.hpp"
+#include "Executor.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <boost/random.hpp>
+#include <boost/bind/bind.hpp>
+
+namespace ESP {
+
+Refiner::Refiner(Network* best, int lambda, std::vector<Environment*>& e, Executor& ex, unsigned int seed) : sigma(0.1),
+																											adapt(0.85),
+																											trials(1),
+																											offspring(lambda),
+																											fitness(lambda),
+																											envts(e),
+																											executor(ex) {
+	if (lambda < 1 || envts.empty()) {
+		std::cerr << "Refiner needs at least one offspring and one Environment; Refiner::Refiner" << std::endl;
+		abort();
+	}
+	for (int i = 0; i < best->getNumNeurons(); ++i) {
+		if (!best->getNeuron(i)->isDense()) {
+			std::cerr << "Neuron " << i << " is sparse; Refiner::Refiner" << std::endl;
+			abort();
+		}
+	}
+	boost::mt19937 master(seed ? seed : time(0));
+	for (unsigned int i = 0; i < envts.size(); ++i) {
+		rngs.push_back(boost::mt19937(master()));
+	}
+	episodes.seed(master());
+	parent = best->clone();
+	*parent = *best;
+	for (int k = 0; k < lambda; ++k) {
+		offspring[k] = best->clone();
+		*offspring[k] = *best;
+	}
+	newSeeds();
+	parentFitness = evaluate(parent, envts[0]);
+}
+
+Refiner::~Refiner() {
+	delete parent;
+	for (unsigned int k = 0; k < offspring.size(); ++k) {
+		delete offspring[k];
+	}
+}
+
+/*!
+ * Draw the trials episodes of a step
+ */
+void Refiner::newSeeds() {
+	seeds.resize(trials);
+	for (int t = 0; t < trials; ++t) {
+		seeds[t] = episodes();
+	}
+}
+
+/*!
+ * Average fitness over the episodes of the step
+ */
+double Refiner::evaluate(Network* net, Environment* envt) {
+	net->resetFitness();
+	envt->evaluateEpisodes(net, seeds);
+	return net->getFitness();
+}
+
+/*!
+ * Perturb and evaluate the offspring of chunk c
+ * Chunk 0 also scores the parent again on the episodes of the step
+ */
+void Refiner::runChunk(int c) {
+	int chunks = envts.size();
+	int n = offspring.size();
+	if (c == 0) {
+		parentFitness = evaluate(parent, envts[0]);
+	}
+	boost::normal_distribution<> normal(0.0, sigma);
+	boost::variate_generator<boost::mt19937&, boost::normal_distribution<> > gauss(rngs[c], normal);
+	for (int k = c * n / chunks; k < (c + 1) * n / chunks; ++k) {
+		Network* child = offspring[k];
+		for (unsigned int i = 0; i < parent->hiddenUnits.size(); ++i) {
+			std::vector<double>& from = parent->hiddenUnits[i]->weight;
+			std::vector<double>& to = child->hiddenUnits[i]->weight;
+			for (unsigned int j = 0; j < from.size(); ++j) {
+				to[j] = from[j] + gauss();
+			}
+			child->hiddenUnits[i]->newID();
+		}
+		fitness[k] = evaluate(child, envts[c]);
+	}
+}
+
+/*!
+ * One (1+lambda) step
+ * Returns the fitness of the parent after selection
+ */
+double Refiner::step() {
+	newSeeds();
+	std::vector<boost::function<void()> > tasks;
+	for (unsigned int c = 0; c < envts.size(); ++c) {
+		tasks.push_back(boost::bind(&Refiner::runChunk, this, c));
+	}
+	executor.runAll(tasks);
+	int best = -1;
+	int successes = 0;
+	double bestFitness = parentFitness;
+	for (unsigned int k = 0; k < offspring.size(); ++k) {
+		if (fitness[k] > parentFitness) {
+			++successes;
+		}
+		if (fitness[k] > bestFitness) {
+			bestFitness = fitness[k];
+			best = k;
+		}
+	}
+	if (best >= 0) {
+		std::swap(parent, offspring[best]);
+		parentFitness = bestFitness;
+	}
+	if (successes * 5 > (int)offspring.size()) {
+		sigma /= adapt;
+	} else if (successes * 5 < (int)offspring.size()) {
+		sigma *= adapt;
+	}
+	return parentFitness;
+}
+
+/*!
+ * Run a number of steps and return the refined fitness
+ */
+double Refiner::refine(int steps) {
+	for (int s = 0; s < steps; ++s) {
+		step();
+	}
+	return parentFitness;
+}
+
+/*!
+ * Copy the refined Neurons back into the subpopulations
+ * Subpopulation i receives hidden unit i in place of its worst
+ * Neuron; its fitness is reset so it is scored with the others.
+ * The subpopulations are not reordered
+ */
+void Refiner::feedBack(std::vector<NeuronPop*>& subpops) {
+	if (subpops.size() != parent->hiddenUnits.size()) {
+		std::cerr << "One subpopulation per hidden unit expected; Refiner::feedBack" << std::endl;
+		abort();
+	}
+	for (unsigned int i = 0; i < subpops.size(); ++i) {
+		Neuron* worst = subpops[i]->individuals.front();
+		for (unsigned int k = 1; k < subpops[i]->individuals.size(); ++k) {
+			if (subpops[i]->individuals[k]->getFitness() < worst->getFitness()) {
+				worst = subpops[i]->individuals[k];
+			}
+		}
+		*worst = *parent->hiddenUnits[i];
+		worst->newID();
+		worst->resetFitness();
+	}
+}
+
+}
@@ -0,0 +1,58 @@
+#ifndef _REFINE_HPP_
+#define _REFINE_HPP_
+
+#include "Population.hpp"
+#include <vector>
+#include <boost/random/mersenne_twister.hpp>
+
+namespace ESP {
+
+class Network;
+class Environment;
+class Executor;
+
+/*!
+ * Parallel local search around the champion Network
+ * Runs a (1+lambda) evolution strategy on the weights of a copy of
+ * the best Network. The lambda offspring are cloned once up front
+ * and perturbed in place every step, so a step allocates nothing.
+ * Offspring are split into one chunk per Environment and the chunks
+ * are evaluated in parallel on the Executor, each with its own
+ * Environment and random stream. Every step draws trials episode
+ * seeds and evaluates the parent and all the offspring on those same
+ * episodes, so selection compares them on common random numbers and
+ * a parent that was scored on a lucky episode is scored again. The
+ * mutation step size follows the 1/5 success rule. feedBack copies
+ * the refined Neurons over the worst Neuron of each subpopulation
+ */
+class Refiner {
+public:
+	Refiner(Network*, int lambda, std::vector<Environment*>&, Executor&, unsigned int seed = 0);
+	~Refiner();
+	double step();
+	double refine(int);
+	void feedBack(std::vector<NeuronPop*>&);
+	inline Network* getBest() { return parent; };
+	inline double getFitness() { return parentFitness; };
+	inline double getSigma() { return sigma; };
+	double sigma;				///< Standard deviation of the weight perturbation
+	double adapt;				///< Factor applied to sigma by the 1/5 success rule
+	int trials;					///< Episodes the parent and each offspring are evaluated on per step
+private:
+	Network* parent;
+	double parentFitness;
+	std::vector<Network*> offspring;
+	std::vector<double> fitness;
+	std::vector<Environment*>& envts;
+	Executor& executor;
+	std::vector<boost::mt19937> rngs;	///< One random stream per chunk
+	boost::mt19937 episodes;			///< Stream of the episode seeds
+	std::vector<unsigned int> seeds;	///< Episodes of the current step
+	void newSeeds();
+	double evaluate(Network*, Environment*);
+	void runChunk(int);
+};
+
+}
+
+#endif
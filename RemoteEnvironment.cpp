@@ -0,0 +1,475 @@
+#include "RemoteEnvironment.hpp"
+#include "Network.hpp"
+#include "NeuroEvolution.hpp"
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <boost/cstdint.hpp>
+
+namespace ESP {
+
+/*!
+ * Record types of the protocol
+ */
+enum { RECORD_RESET = 0, RECORD_ACTION = 1, RECORD_END = 2 };
+
+/*!
+ * Header of a client record, followed by outputDimension doubles
+ * An end record tells the simulator to drop an episode the client
+ * cut off; it gets no reply record. seed is only meaningful in a
+ * reset record with seeded set
+ */
+struct ActionRecord {
+	boost::int32_t episode;
+	boost::int32_t type;
+	boost::uint32_t seed;
+	boost::int32_t seeded;
+};
+
+/*!
+ * Largest frame either side accepts
+ */
+static const boost::int32_t MAX_FRAME = 1 << 30;
+
+/*!
+ * Header of a simulator record, followed by inputDimension doubles
+ */
+struct ObservationRecord {
+	boost::int32_t episode;
+	boost::int32_t done;
+	double reward;
+};
+
+static bool writeAll(int fd, const void* buf, size_t size) {
+	const char* p = static_cast<const char*>(buf);
+	while (size > 0) {
+		ssize_t n = write(fd, p, size);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		p += n;
+		size -= n;
+	}
+	return true;
+}
+
+static bool readAll(int fd, void* buf, size_t size) {
+	char* p = static_cast<char*>(buf);
+	while (size > 0) {
+		ssize_t n = read(fd, p, size);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		p += n;
+		size -= n;
+	}
+	return true;
+}
+
+static bool socketAddress(std::string path, sockaddr_un& addr) {
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(addr.sun_path)) {
+		return false;
+	}
+	strcpy(addr.sun_path, path.c_str());
+	return true;
+}
+
+/*!
+ * Connect to the simulator listening on path
+ * The simulator starts by sending its input and output dimensions
+ */
+RemoteEnvironment::RemoteEnvironment(std::string path, int g, int steps, int l) : sock(-1),
+																				  groups(g > 0 ? g : 1),
+																				  lanes(l > 0 ? l : 1),
+																				  maxSteps(steps),
+																				  incomingPos(0) {
+	name = "remote " + path;
+	inputDimension = 0;
+	outputDimension = 0;
+	sockaddr_un addr;
+	if (!socketAddress(path, addr)) {
+		std::cerr << "Error - socket path too long: " << path << "; RemoteEnvironment::RemoteEnvironment" << std::endl;
+		return;
+	}
+	sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	boost::int32_t dims[2];
+	if (sock < 0 || connect(sock, (sockaddr*)&addr, sizeof(addr)) < 0 || !readAll(sock, dims, sizeof(dims))) {
+		std::cerr << "Error - cannot connect to simulator at " << path << "; RemoteEnvironment::RemoteEnvironment" << std::endl;
+		if (sock >= 0) {
+			close(sock);
+		}
+		sock = -1;
+		return;
+	}
+	inputDimension = dims[0];
+	outputDimension = dims[1];
+	observation.resize(inputDimension);
+}
+
+RemoteEnvironment::~RemoteEnvironment() {
+	if (sock >= 0) {
+		close(sock);
+	}
+}
+
+/*!
+ * Write to the simulator while draining its replies
+ * The simulator may be blocked writing a reply to an earlier frame
+ * while the client writes the next one. Whenever the socket is not
+ * writable the replies that have arrived are read into incoming, so
+ * neither side can fill its send buffer and wait on the other
+ */
+bool RemoteEnvironment::writeDraining(const void* buf, size_t size) {
+	const char* p = static_cast<const char*>(buf);
+	char chunk[65536];
+	while (size > 0) {
+		pollfd pfd;
+		pfd.fd = sock;
+		pfd.events = POLLIN | POLLOUT;
+		pfd.revents = 0;
+		if (poll(&pfd, 1, -1) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		if (pfd.revents & POLLIN) {
+			ssize_t n = recv(sock, chunk, sizeof(chunk), MSG_DONTWAIT);
+			if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+				return false;
+			}
+			if (n > 0) {
+				incoming.insert(incoming.end(), chunk, chunk + n);
+			}
+		}
+		if (pfd.revents & POLLOUT) {
+			ssize_t n = send(sock, p, size, MSG_DONTWAIT | MSG_NOSIGNAL);
+			if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+				return false;
+			}
+			if (n > 0) {
+				p += n;
+				size -= n;
+			}
+		} else if (pfd.revents & (POLLERR | POLLHUP)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*!
+ * Read from the simulator, replies drained earlier first
+ */
+bool RemoteEnvironment::readBuffered(void* buf, size_t size) {
+	char* p = static_cast<char*>(buf);
+	size_t buffered = std::min(size, incoming.size() - incomingPos);
+	if (buffered > 0) {
+		memcpy(p, &incoming[incomingPos], buffered);
+		incomingPos += buffered;
+		if (incomingPos == incoming.size()) {
+			incoming.clear();
+			incomingPos = 0;
+		}
+	}
+	return buffered == size || readAll(sock, p + buffered, size - buffered);
+}
+
+void RemoteEnvironment::sendFrame(const std::vector<char>& frame) {
+	boost::int32_t size = frame.size();
+	if (!writeDraining(&size, sizeof(size)) || (size > 0 && !writeDraining(&frame[0], size))) {
+		std::cerr << "Error - lost connection to simulator; RemoteEnvironment::sendFrame" << std::endl;
+		abort();
+	}
+}
+
+/*!
+ * Receive a frame and return its number of records
+ * A frame answers at most maxRecords records and must hold whole
+ * records; anything else means the simulator broke the protocol
+ */
+int RemoteEnvironment::receiveFrame(std::vector<char>& frame, int maxRecords) {
+	boost::int32_t size;
+	if (!readBuffered(&size, sizeof(size))) {
+		std::cerr << "Error - lost connection to simulator; RemoteEnvironment::receiveFrame" << std::endl;
+		abort();
+	}
+	const size_t stride = sizeof(ObservationRecord) + inputDimension * sizeof(double);
+	if (size < 0 || (size_t)size > maxRecords * stride || size % stride != 0) {
+		std::cerr << "Error - simulator sent a frame of " << size << " bytes; RemoteEnvironment::receiveFrame" << std::endl;
+		abort();
+	}
+	frame.resize(size);
+	if (size > 0 && !readBuffered(&frame[0], size)) {
+		std::cerr << "Error - lost connection to simulator; RemoteEnvironment::receiveFrame" << std::endl;
+		abort();
+	}
+	return size / stride;
+}
+
+static void appendRecord(std::vector<char>& frame, int episode, int type, const std::vector<double>& action, const unsigned int* seed = 0) {
+	ActionRecord r;
+	r.episode = episode;
+	r.type = type;
+	r.seed = seed ? *seed : 0;
+	r.seeded = seed ? 1 : 0;
+	const char* p = reinterpret_cast<const char*>(&r);
+	frame.insert(frame.end(), p, p + sizeof(r));
+	p = reinterpret_cast<const char*>(&action[0]);
+	frame.insert(frame.end(), p, p + action.size() * sizeof(double));
+}
+
+/*!
+ * Run one episode per Network and store the total rewards in fitness
+ * Episode i belongs to nets[i]. Each group starts with lanes
+ * episodes and keeps one frame in flight; when an episode of a group
+ * ends, the next Network starts in its place. Every episode is
+ * started from seed if it is given
+ */
+void RemoteEnvironment::runEpisodes(std::vector<Network*>& nets, std::vector<double>& fitness, const unsigned int* seed) {
+	int n = nets.size();
+	fitness.assign(n, 0.0);
+	std::vector<int> steps(n, 0);
+	std::vector<char> running(n, 0);
+	std::vector<double> action(outputDimension, 0.0), out(outputDimension);
+	std::vector<char> frame, reply;
+	int next = 0, inFlight = 0;
+	for (int g = 0; g < groups && next < n; ++g) {
+		frame.clear();
+		for (int k = 0; k < lanes && next < n; ++k, ++next) {
+			nets[next]->resetActivation();
+			running[next] = 1;
+			appendRecord(frame, next, RECORD_RESET, action, seed);
+		}
+		sendFrame(frame);
+		++inFlight;
+	}
+	const unsigned int stride = sizeof(ObservationRecord) + inputDimension * sizeof(double);
+	while (inFlight > 0) {
+		int count = receiveFrame(reply, lanes);
+		--inFlight;
+		frame.clear();
+		for (int r = 0; r < count; ++r) {
+			const ObservationRecord* rec = reinterpret_cast<const ObservationRecord*>(&reply[r * stride]);
+			const double* obs = reinterpret_cast<const double*>(rec + 1);
+			int ep = rec->episode;
+			if (ep < 0 || ep >= n || !running[ep]) {
+				std::cerr << "Error - simulator answered for episode " << ep << ", which is not running; RemoteEnvironment::runEpisodes" << std::endl;
+				abort();
+			}
+			fitness[ep] += rec->reward;
+			if (rec->done || steps[ep] >= maxSteps) {
+				if (!rec->done) {
+					appendRecord(frame, ep, RECORD_END, action);
+				}
+				running[ep] = 0;
+				if (next < n) {
+					nets[next]->resetActivation();
+					running[next] = 1;
+					appendRecord(frame, next, RECORD_RESET, action, seed);
+					++next;
+				}
+				continue;
+			}
+			observation.assign(obs, obs + inputDimension);
+			nets[ep]->activate(observation, out);
+			++steps[ep];
+			appendRecord(frame, ep, RECORD_ACTION, out);
+		}
+		if (!frame.empty()) {
+			sendFrame(frame);
+			++inFlight;
+		}
+	}
+}
+
+/*!
+ * Store the fitness of a batch for evalNet to collect
+ */
+void RemoteEnvironment::collect(std::vector<Network*>& nets, std::vector<double>& fitness) {
+	for (unsigned int i = 0; i < nets.size(); ++i) {
+		results[nets[i]] = fitness[i];
+	}
+}
+
+/*!
+ * Evaluate a batch of Networks with pipelined episodes
+ * The episodes are run first and each Network is then passed to
+ * evaluateNetwork, which collects the stored result through evalNet,
+ * so fitness is still only assigned by evaluateNetwork. If the
+ * NeuroEvolution has common episodes, the batch is run on each of
+ * them in turn, as evaluateEpisodes would
+ */
+void RemoteEnvironment::evaluateNetworks(std::vector<Network*>& nets) {
+	if (nePtr && !nePtr->episodeSeeds.empty()) {
+		for (unsigned int e = 0; e < nePtr->episodeSeeds.size(); ++e) {
+			evaluateNetworks(nets, nePtr->episodeSeeds[e]);
+		}
+		return;
+	}
+	std::vector<double> fitness;
+	runEpisodes(nets, fitness, 0);
+	collect(nets, fitness);
+	for (unsigned int i = 0; i < nets.size(); ++i) {
+		evaluateNetwork(nets[i]);
+	}
+}
+
+/*!
+ * Evaluate a batch of Networks on the episode given by seed
+ * Same as above, with every Network facing the same episode
+ */
+void RemoteEnvironment::evaluateNetworks(std::vector<Network*>& nets, unsigned int seed) {
+	std::vector<double> fitness;
+	runEpisodes(nets, fitness, &seed);
+	collect(nets, fitness);
+	for (unsigned int i = 0; i < nets.size(); ++i) {
+		evaluateNetwork(nets[i], seed);
+	}
+}
+
+double RemoteEnvironment::evalNet(Network* net) {
+	std::map<Network*, double>::iterator i = results.find(net);
+	if (i != results.end()) {
+		double fit = i->second;
+		results.erase(i);
+		return fit;
+	}
+	std::vector<Network*> nets(1, net);
+	std::vector<double> fitness;
+	unsigned int seed = getEpisodeSeed();
+	runEpisodes(nets, fitness, hasEpisodeSeed() ? &seed : 0);
+	return fitness[0];
+}
+
+void RemoteEnvironment::setupInput(std::vector<double>& input) {
+	input = observation;
+}
+
+LocalSimulator::LocalSimulator(int in, int out) : inputDimension(in), outputDimension(out) {
+}
+
+void LocalSimulator::reset(int episode, const unsigned int* seed, double* obs) {
+	std::vector<double>& s = state[episode];
+	s.assign(3, 0.0);
+	s[0] = 0.1 * (((seed ? *seed : episode) % 7) - 3);
+	obs[0] = s[0];
+	obs[1] = s[1];
+}
+
+bool LocalSimulator::step(int episode, const double* action, double* obs, double& reward) {
+	std::vector<double>& s = state[episode];
+	const double dt = 0.02;
+	double force = 2.0 * (action[0] - 0.5) - 0.5 * s[0];
+	s[1] += dt * force;
+	s[0] += dt * s[1] + 0.01 * sin(s[2] * 0.3);
+	s[2] += 1.0;
+	obs[0] = s[0];
+	obs[1] = s[1];
+	reward = 1.0;
+	return fabs(s[0]) >= 1.0;
+}
+
+/*!
+ * Serve a connected client until it disconnects
+ */
+void LocalSimulator::serve(int fd) {
+	boost::int32_t dims[2] = { inputDimension, outputDimension };
+	if (!writeAll(fd, dims, sizeof(dims))) {
+		return;
+	}
+	const unsigned int inStride = sizeof(ActionRecord) + outputDimension * sizeof(double);
+	const unsigned int outStride = sizeof(ObservationRecord) + inputDimension * sizeof(double);
+	std::vector<char> frame, reply;
+	boost::int32_t size;
+	while (readAll(fd, &size, sizeof(size))) {
+		if (size < 0 || size > MAX_FRAME || size % inStride != 0) {
+			std::cerr << "Error - client sent a frame of " << size << " bytes; LocalSimulator::serve" << std::endl;
+			return;
+		}
+		frame.resize(size);
+		if (size > 0 && !readAll(fd, &frame[0], size)) {
+			return;
+		}
+		int count = size / inStride;
+		reply.assign(count * outStride, 0);
+		int replies = 0;
+		for (int r = 0; r < count; ++r) {
+			const ActionRecord* in = reinterpret_cast<const ActionRecord*>(&frame[r * inStride]);
+			if (in->type == RECORD_END) {
+				state.erase(in->episode);
+				continue;
+			}
+			ObservationRecord* out = reinterpret_cast<ObservationRecord*>(&reply[replies++ * outStride]);
+			double* obs = reinterpret_cast<double*>(out + 1);
+			out->episode = in->episode;
+			out->reward = 0.0;
+			out->done = 0;
+			if (in->type == RECORD_RESET) {
+				unsigned int seed = in->seed;
+				reset(in->episode, in->seeded ? &seed : 0, obs);
+			} else {
+				out->done = step(in->episode, reinterpret_cast<const double*>(in + 1), obs, out->reward) ? 1 : 0;
+				if (out->done) {
+					state.erase(in->episode);
+				}
+			}
+		}
+		size = replies * outStride;
+		if (!writeAll(fd, &size, sizeof(size)) || (size > 0 && !writeAll(fd, &reply[0], size))) {
+			return;
+		}
+	}
+}
+
+/*!
+ * Start the simulator in a child process listening on path
+ * The child serves a single client and exits. Returns the pid of the
+ * child, or -1 on failure. The socket is listening when spawn returns
+ */
+pid_t LocalSimulator::spawn(std::string path) {
+	sockaddr_un addr;
+	if (!socketAddress(path, addr)) {
+		std::cerr << "Error - socket path too long: " << path << "; LocalSimulator::spawn" << std::endl;
+		return -1;
+	}
+	unlink(path.c_str());
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0 || bind(listener, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, 1) < 0) {
+		std::cerr << "Error - cannot listen on " << path << "; LocalSimulator::spawn" << std::endl;
+		if (listener >= 0) {
+			close(listener);
+		}
+		return -1;
+	}
+	pid_t pid = fork();
+	if (pid == 0) {
+		int fd = accept(listener, 0, 0);
+		close(listener);
+		if (fd >= 0) {
+			serve(fd);
+			close(fd);
+		}
+		unlink(path.c_str());
+		_exit(0);
+	}
+	close(listener);
+	return pid;
+}
+
+}
@@ -0,0 +1,86 @@
+#ifndef _REMOTEENVIRONMENT_HPP_
+#define _REMOTEENVIRONMENT_HPP_
+
+#include "Environment.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <sys/types.h>
+
+namespace ESP {
+
+class Network;
+
+/*!
+ * Environment backed by a simulator in another process
+ * Talks to the simulator over a Unix domain socket. Episodes are
+ * exchanged in frames: a frame from the client holds one reset or
+ * action record per episode, and the simulator answers every frame
+ * with one frame holding the observation, reward and termination
+ * flag of each of those episodes. evaluateNetworks keeps groups
+ * times lanes episodes in flight, split into groups of lanes
+ * episodes that each have a frame outstanding, so the simulator
+ * steps one group while the Networks of another group are being
+ * activated; when an episode ends the next Network takes its place
+ * in the group. A reset record carries the episode seed when the
+ * Networks are evaluated on common episodes, so the simulator can
+ * start every Network from the same state. While the client
+ * writes a frame it keeps reading the replies that arrive, so
+ * frames larger than the socket buffers cannot deadlock the two
+ * processes. Episodes cut off at maxSteps are ended explicitly so
+ * the simulator can drop their state
+ */
+class RemoteEnvironment : public Environment {
+public:
+	RemoteEnvironment(std::string, int groups = 2, int maxSteps = 1000, int lanes = 1);
+	virtual ~RemoteEnvironment();
+	void evaluateNetworks(std::vector<Network*>&);
+	void evaluateNetworks(std::vector<Network*>&, unsigned int);
+	inline bool isConnected() { return sock >= 0; };
+protected:
+	int sock;
+	int groups;					///< Number of frames kept in flight
+	int lanes;					///< Episodes in flight in each group
+	int maxSteps;				///< Maximum number of steps of an episode
+	std::vector<double> observation;	///< Last observation received
+	std::map<Network*, double> results;	///< Fitness computed by evaluateNetworks, not yet collected
+	virtual void setupInput(std::vector<double>&);
+	virtual double evalNet(Network*);
+private:
+	void runEpisodes(std::vector<Network*>&, std::vector<double>&, const unsigned int*);
+	void collect(std::vector<Network*>&, std::vector<double>&);
+	std::vector<char> incoming;	///< Replies read while a frame was being written
+	size_t incomingPos;			///< Next unread byte of incoming
+	bool writeDraining(const void*, size_t);
+	bool readBuffered(void*, size_t);
+	void sendFrame(const std::vector<char>&);
+	int receiveFrame(std::vector<char>&, int);
+};
+
+/*!
+ * Stand-in simulator for testing RemoteEnvironment
+ * Serves the RemoteEnvironment protocol for a simple task: a point
+ * mass on a line that the Network must keep inside [-1, 1] by
+ * pushing it, with action 0.5 meaning no force. The reward is 1 per
+ * step survived. Derived classes can serve other tasks by
+ * overriding reset and step; reset is given the episode seed, or 0
+ * if the client did not send one, and must derive the initial state
+ * from it when there is one
+ */
+class LocalSimulator {
+public:
+	LocalSimulator(int inputs = 2, int outputs = 1);
+	virtual ~LocalSimulator() {};
+	void serve(int);
+	pid_t spawn(std::string);
+protected:
+	int inputDimension;
+	int outputDimension;
+	std::map<int, std::vector<double> > state;	///< State of each live episode
+	virtual void reset(int, const unsigned int*, double*);
+	virtual bool step(int, const double*, double*, double&);
+};
+
+}
+
+#endif
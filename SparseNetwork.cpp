@@ -0,0 +1,159 @@
+#include "SparseNetwork.hpp"
+#include "SparseNeuron.hpp"
+#include <iostream>
+#include <algorithm>
+
+namespace ESP {
+
+const TypeDescriptor SparseNetwork::descriptor = { "sparse network", 101 };
+static RegisterType registerSparseNetwork(SparseNetwork::descriptor);
+
+SparseNetwork::SparseNetwork(int in, int hid, int out, int c) : Network(in, hid, out),
+																connections(c) {
+	geneSize = in + out;
+}
+
+Network* SparseNetwork::newNetwork(int in, int hid, int out) {
+	return new SparseNetwork(in, hid, out, connections);
+}
+
+Network* SparseNetwork::clone() {
+	return new SparseNetwork(numInputs, hiddenUnits.size(), numOutputs, connections);
+}
+
+void SparseNetwork::create(boost::mt19937& rng) {
+	for (unsigned int i = 0; i < hiddenUnits.size(); ++i) {
+		hiddenUnits[i] = new SparseNeuron(geneSize, connections);
+		hiddenUnits[i]->create(rng);
+	}
+	created = true;
+}
+
+void SparseNetwork::addNeuron() {
+	Neuron* n = new SparseNeuron(geneSize, connections);
+	n->create();
+	hiddenUnits.push_back(n);
+	activation.push_back(0.0);
+}
+
+void SparseNetwork::removeNeuron(int i) {
+	if (i < 0 || i >= (int)hiddenUnits.size() || (int)hiddenUnits.size() <= getMinUnits()) {
+		std::cerr << "Cannot remove Neuron " << i << "; SparseNetwork::removeNeuron" << std::endl;
+		return;
+	}
+	if (created) {
+		delete hiddenUnits[i];
+	}
+	hiddenUnits.erase(hiddenUnits.begin() + i);
+	activation.erase(activation.begin() + i);
+}
+
+int SparseNetwork::getNumConnections() {
+	int n = 0;
+	for (unsigned int i = 0; i < hiddenUnits.size(); ++i) {
+		n += hiddenUnits[i]->getSize();
+	}
+	return n;
+}
+
+/*!
+ * Hidden Neuron i, which must be a SparseNeuron
+ */
+static SparseNeuron* sparseNeuron(std::vector<Neuron*>& hiddenUnits, int i, const char* method) {
+	if (&hiddenUnits[i]->getDescriptor() != &SparseNeuron::descriptor) {
+		std::cerr << "Neuron " << i << " is a " << hiddenUnits[i]->getName() << "; SparseNetwork::" << method << std::endl;
+		abort();
+	}
+	return static_cast<SparseNeuron*>(hiddenUnits[i]);
+}
+
+/*!
+ * Pack the Neurons into compressed sparse rows
+ * Does nothing if the rows already hold the current connections
+ */
+void SparseNetwork::pack() {
+	int hid = hiddenUnits.size();
+	bool current = (int)packedIDs.size() == hid;
+	for (int i = 0; i < hid && current; ++i) {
+		current = packedIDs[i] == (hiddenUnits[i]->lesioned ? -hiddenUnits[i]->getID() : hiddenUnits[i]->getID());
+	}
+	if (current) {
+		return;
+	}
+	packedIDs.resize(hid);
+	rowStart.resize(hid + 1);
+	rowSplit.resize(hid);
+	column.clear();
+	value.clear();
+	rowStart[0] = 0;
+	for (int i = 0; i < hid; ++i) {
+		SparseNeuron* n = sparseNeuron(hiddenUnits, i, "pack");
+		int size = n->lesioned ? 0 : n->getSize();
+		const int* idx = n->getIndices();
+		const double* w = n->getWeights();
+		column.insert(column.end(), idx, idx + size);
+		value.insert(value.end(), w, w + size);
+		rowStart[i + 1] = column.size();
+		rowSplit[i] = std::lower_bound(column.begin() + rowStart[i], column.end(), numInputs) - column.begin();
+		packedIDs[i] = n->lesioned ? -n->getID() : n->getID();
+	}
+}
+
+/*!
+ * Activate the Network on a single input
+ */
+void SparseNetwork::activate(std::vector<double>& input, std::vector<double>& output) {
+	output.assign(numOutputs, 0.0);
+	for (unsigned int i = 0; i < hiddenUnits.size(); ++i) {
+		SparseNeuron* n = sparseNeuron(hiddenUnits, i, "activate");
+		if (n->lesioned) {
+			activation[i] = 0.0;
+			continue;
+		}
+		const int* idx = n->getIndices();
+		const double* w = n->getWeights();
+		int size = n->getSize();
+		int k = 0;
+		double sum = 0.0;
+		for (; k < size && idx[k] < numInputs; ++k) {
+			sum += w[k] * input[idx[k]];
+		}
+		activation[i] = sigmoid(sum);
+		for (; k < size; ++k) {
+			output[idx[k] - numInputs] += activation[i] * w[k];
+		}
+	}
+	for (int j = 0; j < numOutputs; ++j) {
+		output[j] = sigmoid(output[j]);
+	}
+}
+
+/*!
+ * Activate the Network on a batch of inputs stored row-major
+ */
+void SparseNetwork::activateBatch(std::vector<double>& inputs, std::vector<double>& outputs, int batch) {
+	pack();
+	int hid = hiddenUnits.size();
+	outputs.assign(batch * numOutputs, 0.0);
+	const int* col = column.empty() ? 0 : &column[0];
+	const double* val = value.empty() ? 0 : &value[0];
+	for (int b = 0; b < batch; ++b) {
+		const double* in = &inputs[b * numInputs];
+		double* out = &outputs[b * numOutputs];
+		for (int i = 0; i < hid; ++i) {
+			double sum = 0.0;
+			for (int k = rowStart[i]; k < rowSplit[i]; ++k) {
+				sum += val[k] * in[col[k]];
+			}
+			double act = sigmoid(sum);
+			for (int k = rowSplit[i]; k < rowStart[i + 1]; ++k) {
+				out[col[k] - numInputs] += act * val[k];
+			}
+		}
+		for (int j = 0; j < numOutputs; ++j) {
+			outputs[b * numOutputs + j] = sigmoid(outputs[b * numOutputs + j]);
+		}
+	}
+}
+
+}
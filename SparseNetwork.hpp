@@ -0,0 +1,49 @@
+#ifndef _SPARSENETWORK_HPP_
+#define _SPARSENETWORK_HPP_
+
+#include "Network.hpp"
+#include <vector>
+
+namespace ESP {
+
+class Neuron;
+
+/*!
+ * Feed-forward Network of SparseNeurons
+ * Each hidden Neuron has a dense dimension of numInputs + numOutputs:
+ * connections below numInputs come from the inputs and the rest go
+ * to the outputs. Batched activation first packs the Neurons into
+ * compressed sparse rows and then works only on the stored
+ * connections, so its cost scales with the number of connections
+ * rather than with numInputs. As in FeedForwardNetwork the rows are
+ * repacked only when a Neuron ID changed
+ */
+class SparseNetwork : public Network {
+public:
+	static const TypeDescriptor descriptor;
+	SparseNetwork(int, int, int, int connections);
+	virtual Network* newNetwork(int, int, int);
+	virtual Network* clone();
+	virtual const TypeDescriptor& getDescriptor() { return descriptor; };
+	using Network::create;
+	virtual void create(boost::mt19937&);
+	virtual void growNeuron(Neuron*) {};
+	virtual void shrinkNeuron(Neuron*, int) {};
+	virtual void addNeuron();
+	virtual void removeNeuron(int);
+	virtual void activate(std::vector<double>&, std::vector<double>&);
+	virtual void activateBatch(std::vector<double>&, std::vector<double>&, int);
+	int getNumConnections();
+protected:
+	int connections;			///< Connections of a newly created Neuron
+	std::vector<int> rowStart;	///< CSR row offsets, one row per hidden Neuron
+	std::vector<int> rowSplit;	///< First output connection of each row
+	std::vector<int> column;
+	std::vector<double> value;
+	std::vector<int> packedIDs;	///< IDs of the Neurons the rows hold, negated for lesioned Neurons
+	void pack();
+};
+
+}
+
+#endif
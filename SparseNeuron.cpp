@@ -0,0 +1,171 @@
+#include "SparseNeuron.hpp"
+#include <iostream>
+#include <algorithm>
+#include <boost/random.hpp>
+
+namespace ESP {
+
+const TypeDescriptor SparseNeuron::descriptor = { "sparse neuron", 1 };
+static RegisterType registerSparseNeuron(SparseNeuron::descriptor);
+
+SparseNeuron::SparseNeuron(int dim, int connections) : Neuron(0),
+													   dimension(dim),
+													   numConnections(std::min(connections, dim)) {
+}
+
+/*!
+ * Position of a connection in index, -1 if it does not exist
+ */
+int SparseNeuron::find(int i) {
+	std::vector<int>::iterator k = std::lower_bound(index.begin(), index.end(), i);
+	return (k != index.end() && *k == i) ? k - index.begin() : -1;
+}
+
+double SparseNeuron::getDenseWeight(int i) {
+	int k = find(i);
+	return k < 0 ? 0.0 : weight[k];
+}
+
+Neuron& SparseNeuron::operator=(const Neuron& n) {
+	const SparseNeuron* s = dynamic_cast<const SparseNeuron*>(&n);
+	if (!s) {
+		std::cerr << "Assigning a " << const_cast<Neuron&>(n).getName() << " to a sparse neuron; SparseNeuron::operator=" << std::endl;
+		abort();
+	}
+	Neuron::operator=(n);
+	index = s->index;
+	dimension = s->dimension;
+	numConnections = s->numConnections;
+	return *this;
+}
+
+/*!
+ * Creates numConnections random connections with random weights
+ */
+void SparseNeuron::create(boost::mt19937& rng) {
+	boost::uniform_real<> dist(0.0, 12.0);
+	std::vector<int> all(dimension);
+	for (int i = 0; i < dimension; ++i) {
+		all[i] = i;
+	}
+	for (int i = 0; i < numConnections; ++i) {
+		boost::uniform_int<> pick(i, dimension - 1);
+		std::swap(all[i], all[pick(rng)]);
+	}
+	index.assign(all.begin(), all.begin() + numConnections);
+	std::sort(index.begin(), index.end());
+	weight.resize(numConnections);
+	for (int i = 0; i < numConnections; ++i) {
+		weight[i] = dist(rng) - 6.0;
+	}
+	newID();
+}
+
+/*!
+ * Add a connection, or set its weight if it exists
+ */
+void SparseNeuron::connect(int i, double w) {
+	if (i < 0 || i >= dimension) {
+		std::cerr << "Connection out of bounds; SparseNeuron::connect" << std::endl;
+		abort();
+	}
+	std::vector<int>::iterator k = std::lower_bound(index.begin(), index.end(), i);
+	int pos = k - index.begin();
+	if (k != index.end() && *k == i) {
+		weight[pos] = w;
+	} else {
+		index.insert(k, i);
+		weight.insert(weight.begin() + pos, w);
+	}
+	newID();
+}
+
+void SparseNeuron::disconnect(int i) {
+	int k = find(i);
+	if (k >= 0) {
+		index.erase(index.begin() + k);
+		weight.erase(weight.begin() + k);
+		newID();
+	}
+}
+
+/*!
+ * Insert a new unconnected position at locus
+ */
+void SparseNeuron::addConnection(int locus) {
+	for (int k = std::lower_bound(index.begin(), index.end(), locus) - index.begin(); k < (int)index.size(); ++k) {
+		++index[k];
+	}
+	++dimension;
+	newID();
+}
+
+/*!
+ * Remove position locus and its connection
+ */
+void SparseNeuron::removeConnection(int locus) {
+	disconnect(locus);
+	for (int k = std::lower_bound(index.begin(), index.end(), locus) - index.begin(); k < (int)index.size(); ++k) {
+		--index[k];
+	}
+	--dimension;
+	newID();
+}
+
+/*!
+ * Mutate a Neuron
+ * Usually perturbs a connection with Cauchy noise; sometimes adds a
+ * new random connection or removes an existing one instead
+ */
+void SparseNeuron::mutate(boost::mt19937& rng) {
+	boost::uniform_real<> dist(0.0, 1.0);
+	double r = dist(rng);
+	if ((r < 0.1 || index.empty()) && (int)index.size() < dimension) {
+		boost::uniform_int<> pos(0, dimension - 1);
+		int i = pos(rng);
+		while (find(i) >= 0) {
+			i = pos(rng);
+		}
+		connect(i, rndCauchy(0.3, rng));
+	} else if (r < 0.2 && index.size() > 1) {
+		boost::uniform_int<> k(0, index.size() - 1);
+		disconnect(index[k(rng)]);
+	} else if (!index.empty()) {
+		boost::uniform_int<> k(0, index.size() - 1);
+		weight[k(rng)] += rndCauchy(0.3, rng);
+	}
+	newID();
+}
+
+/*!
+ * Become a perturbation of n, connections included
+ */
+void SparseNeuron::perturb(const Neuron* n, double (*randFn)(double), double coeff) {
+	*this = *n;
+	for (unsigned int i = 0; i < weight.size(); ++i) {
+		weight[i] += (randFn)(coeff);
+	}
+	newID();
+	resetFitness();
+}
+
+void SparseNeuron::perturb(const Neuron* n, double coeff, boost::mt19937& rng) {
+	*this = *n;
+	for (unsigned int i = 0; i < weight.size(); ++i) {
+		weight[i] += rndCauchy(coeff, rng);
+	}
+	newID();
+	resetFitness();
+}
+
+Neuron* SparseNeuron::perturb(double coeff, boost::mt19937& rng) {
+	SparseNeuron* n = new SparseNeuron(dimension, numConnections);
+	n->index = index;
+	n->weight.resize(weight.size());
+	for (unsigned int i = 0; i < weight.size(); ++i) {
+		n->weight[i] = weight[i] + rndCauchy(coeff, rng);
+	}
+	return n;
+}
+
+}
@@ -0,0 +1,52 @@
+#ifndef _SPARSENEURON_HPP_
+#define _SPARSENEURON_HPP_
+
+#include "Neuron.hpp"
+#include <vector>
+
+namespace ESP {
+
+/*!
+ * Neuron with sparse connectivity
+ * Only the connections that exist are stored: index holds their
+ * positions in the dense weight vector of length dimension, sorted,
+ * and the inherited weight vector holds their values, so getSize
+ * and getWeight refer to the stored connections. Adding or removing
+ * an input only shifts indices, and mutation can also add and remove
+ * connections, so the cost of a Neuron scales with its connections
+ * instead of its dimension
+ */
+class SparseNeuron : public Neuron {
+public:
+	static const TypeDescriptor descriptor;
+	SparseNeuron(int dimension, int connections);
+	virtual Neuron* clone() { return new SparseNeuron(dimension, numConnections); };
+	virtual const TypeDescriptor& getDescriptor() { return descriptor; };
+	virtual Neuron& operator=(const Neuron&);
+	using Neuron::create;
+	virtual void create(boost::mt19937&);
+	using Neuron::mutate;
+	virtual void mutate(boost::mt19937&);
+	virtual void addConnection(int);
+	virtual void removeConnection(int);
+	using Neuron::perturb;
+	virtual void perturb(const Neuron*, double (*randFn)(double), double);
+	virtual void perturb(const Neuron*, double, boost::mt19937&);
+	virtual Neuron* perturb(double, boost::mt19937&);
+	void connect(int, double);
+	void disconnect(int);
+	double getDenseWeight(int);
+	inline int getIndex(int k) { return index[k]; };
+	inline const int* getIndices() { return index.empty() ? 0 : &index[0]; };
+	inline int getDimension() { return dimension; };
+	friend class NeuroEvolution;
+protected:
+	std::vector<int> index;		///< Sorted positions of the connections
+	int dimension;				///< Length of the equivalent dense weight vector
+	int numConnections;			///< Number of connections of a newly created Neuron
+	int find(int);
+};
+
+}
+
+#endif
@@ -0,0 +1,245 @@
+#include "Surrogate.hpp"
+#include "Network.hpp"
+#include "Neuron.hpp"
+#include "Environment.hpp"
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <boost/random.hpp>
+
+namespace ESP {
+
+Surrogate::Surrogate(int f, double l, double fg) : explore(2),
+												   numFeatures(f),
+												   lambda(l),
+												   forget(fg),
+												   inputSize(-1),
+												   gram((f + 1) * (f + 1), 0.0),
+												   moment(f + 1, 0.0),
+												   coeff(f + 1, 0.0),
+												   stale(false),
+												   observations(0),
+												   predicted(0),
+												   error(0.0),
+												   correlation(0.0) {
+}
+
+/*!
+ * Feature vector of a Network
+ * The weights of all the Neurons, projected down to numFeatures if
+ * there are more, followed by a constant 1 for the intercept
+ */
+void Surrogate::features(Network* net, std::vector<double>& x) {
+	std::vector<double> w;
+	for (int i = 0; i < net->getNumNeurons(); ++i) {
+		Neuron* n = net->getNeuron(i);
+		const double* p = n->getWeights();
+		if (p) {
+			w.insert(w.end(), p, p + n->getSize());
+		}
+	}
+	if (inputSize < 0) {
+		inputSize = w.size();
+		if (inputSize > numFeatures) {
+			boost::mt19937 rng(12345);
+			boost::normal_distribution<> normal(0.0, 1.0 / sqrt((double)numFeatures));
+			boost::variate_generator<boost::mt19937&, boost::normal_distribution<> > gauss(rng, normal);
+			projection.resize(numFeatures * inputSize);
+			for (unsigned int i = 0; i < projection.size(); ++i) {
+				projection[i] = gauss();
+			}
+		}
+	}
+	if ((int)w.size() != inputSize) {
+		std::cerr << "Network has " << w.size() << " weights, surrogate expects " << inputSize << "; Surrogate::features" << std::endl;
+		abort();
+	}
+	x.assign(numFeatures + 1, 0.0);
+	if (projection.empty()) {
+		std::copy(w.begin(), w.end(), x.begin());
+	} else {
+		for (int f = 0; f < numFeatures; ++f) {
+			const double* row = &projection[f * inputSize];
+			double sum = 0.0;
+			for (int i = 0; i < inputSize; ++i) {
+				sum += row[i] * w[i];
+			}
+			x[f] = sum;
+		}
+	}
+	x[numFeatures] = 1.0;
+}
+
+/*!
+ * Add an evaluated Network to the model
+ */
+void Surrogate::observe(Network* net, double fitness) {
+	std::vector<double> x;
+	features(net, x);
+	int d = numFeatures + 1;
+	for (int i = 0; i < d; ++i) {
+		for (int j = 0; j < d; ++j) {
+			gram[i * d + j] = forget * gram[i * d + j] + x[i] * x[j];
+		}
+		moment[i] = forget * moment[i] + x[i] * fitness;
+	}
+	++observations;
+	stale = true;
+}
+
+/*!
+ * Solve (X'X + lambda I) coeff = X'y by Cholesky decomposition
+ */
+void Surrogate::solve() {
+	int d = numFeatures + 1;
+	std::vector<double> l(gram);
+	for (int i = 0; i < d; ++i) {
+		l[i * d + i] += lambda;
+	}
+	for (int j = 0; j < d; ++j) {
+		double s = l[j * d + j];
+		for (int k = 0; k < j; ++k) {
+			s -= l[j * d + k] * l[j * d + k];
+		}
+		l[j * d + j] = sqrt(std::max(s, 1e-12));
+		for (int i = j + 1; i < d; ++i) {
+			double t = l[i * d + j];
+			for (int k = 0; k < j; ++k) {
+				t -= l[i * d + k] * l[j * d + k];
+			}
+			l[i * d + j] = t / l[j * d + j];
+		}
+	}
+	for (int i = 0; i < d; ++i) {
+		double t = moment[i];
+		for (int k = 0; k < i; ++k) {
+			t -= l[i * d + k] * coeff[k];
+		}
+		coeff[i] = t / l[i * d + i];
+	}
+	for (int i = d - 1; i >= 0; --i) {
+		double t = coeff[i];
+		for (int k = i + 1; k < d; ++k) {
+			t -= l[k * d + i] * coeff[k];
+		}
+		coeff[i] = t / l[i * d + i];
+	}
+	stale = false;
+}
+
+double Surrogate::predict(Network* net) {
+	if (stale) {
+		solve();
+	}
+	std::vector<double> x;
+	features(net, x);
+	double y = 0.0;
+	for (int i = 0; i <= numFeatures; ++i) {
+		y += coeff[i] * x[i];
+	}
+	return y;
+}
+
+/*!
+ * Assign predicted fitness to a Network that is not evaluated
+ */
+void Surrogate::credit(Network* net, double fitness) {
+	net->setFitness(fitness);
+	++predicted;
+}
+
+/*!
+ * Ranks of a set of values, ties get their mean rank
+ */
+static void ranks(const std::vector<double>& v, std::vector<double>& r) {
+	int n = v.size();
+	std::vector<std::pair<double, int> > order(n);
+	for (int i = 0; i < n; ++i) {
+		order[i] = std::make_pair(v[i], i);
+	}
+	std::sort(order.begin(), order.end());
+	r.resize(n);
+	for (int i = 0; i < n;) {
+		int j = i;
+		while (j < n && order[j].first == order[i].first) {
+			++j;
+		}
+		for (int k = i; k < j; ++k) {
+			r[order[k].second] = 0.5 * (i + j - 1);
+		}
+		i = j;
+	}
+}
+
+static double spearman(const std::vector<double>& a, const std::vector<double>& b) {
+	std::vector<double> ra, rb;
+	ranks(a, ra);
+	ranks(b, rb);
+	int n = a.size();
+	double ma = 0.5 * (n - 1), sab = 0.0, saa = 0.0, sbb = 0.0;
+	for (int i = 0; i < n; ++i) {
+		sab += (ra[i] - ma) * (rb[i] - ma);
+		saa += (ra[i] - ma) * (ra[i] - ma);
+		sbb += (rb[i] - ma) * (rb[i] - ma);
+	}
+	return (saa > 0.0 && sbb > 0.0) ? sab / sqrt(saa * sbb) : 0.0;
+}
+
+/*!
+ * Evaluate the most promising fraction of a set of Networks
+ * Until the model has more observations than features every Network
+ * is evaluated. Afterwards the Networks are ranked by predicted
+ * fitness, and the best fraction plus explore Networks drawn at
+ * random from the rest are evaluated on the common episodes of the
+ * generation with evaluateEpisodes. The others are credited with
+ * their predicted fitness. Evaluations abandoned by racing only
+ * give a bound on fitness, so they are not used to update the model
+ * or to measure it
+ */
+void Surrogate::screen(std::vector<Network*>& nets, double fraction, Environment& envt, boost::mt19937& rng) {
+	int n = nets.size();
+	if (!isTrained()) {
+		for (int i = 0; i < n; ++i) {
+			envt.evaluateEpisodes(nets[i]);
+			if (!envt.wasPruned()) {
+				observe(nets[i], nets[i]->getFitness());
+			}
+		}
+		return;
+	}
+	std::vector<std::pair<double, int> > order(n);
+	for (int i = 0; i < n; ++i) {
+		order[i] = std::make_pair(-predict(nets[i]), i);
+	}
+	std::sort(order.begin(), order.end());
+	int evaluate = std::max(1, std::min(n, (int)ceil(fraction * n)));
+	// Move explore random Networks of the rest up behind the best fraction
+	for (int e = 0; e < explore && evaluate < n; ++e, ++evaluate) {
+		boost::uniform_int<> dist(evaluate, n - 1);
+		std::swap(order[evaluate], order[dist(rng)]);
+	}
+	std::vector<double> pred, actual;
+	std::vector<Network*> evaluated;
+	for (int k = 0; k < n; ++k) {
+		Network* net = nets[order[k].second];
+		double p = -order[k].first;
+		if (k < evaluate) {
+			envt.evaluateEpisodes(net);
+			if (!envt.wasPruned()) {
+				pred.push_back(p);
+				actual.push_back(net->getFitness());
+				evaluated.push_back(net);
+			}
+		} else {
+			credit(net, p);
+		}
+	}
+	error = 0.0;
+	for (unsigned int i = 0; i < pred.size(); ++i) {
+		error += fabs(pred[i] - actual[i]) / pred.size();
+		observe(evaluated[i], actual[i]);
+	}
+	correlation = pred.size() > 2 ? spearman(pred, actual) : 0.0;
+}
+
+}
@@ -0,0 +1,61 @@
+#ifndef _SURROGATE_HPP_
+#define _SURROGATE_HPP_
+
+#include "Neuron.hpp"
+#include <vector>
+
+namespace ESP {
+
+class Network;
+class Environment;
+
+/*!
+ * Surrogate fitness model for pre-screening Networks
+ * An online ridge regression from the weights of a Network to the
+ * fitness it was assigned by Environment::evaluateNetwork. Networks
+ * with more weights than the model has features are reduced with a
+ * fixed random projection. Old observations are discounted by a
+ * forgetting factor so the model follows the population as it
+ * moves. Each generation screen ranks the candidate Networks by
+ * predicted fitness, evaluates only the best fraction and a few
+ * random others, and credits the rest with their predicted fitness.
+ * The random ones keep the model from never learning about the
+ * Networks it ranks low. The prediction error and rank correlation
+ * on the evaluated Networks are kept as a measure of how far the
+ * surrogate can be trusted
+ */
+class Surrogate {
+public:
+	Surrogate(int features = 64, double lambda = 1.0, double forget = 0.995);
+	void observe(Network*, double);
+	double predict(Network*);
+	void screen(std::vector<Network*>& nets, double fraction, Environment& envt) { screen(nets, fraction, envt, defaultRng()); };
+	void screen(std::vector<Network*>&, double, Environment&, boost::mt19937&);
+	inline bool isTrained() { return observations > numFeatures; };
+	inline int getObservations() { return observations; };
+	inline int getPredicted() { return predicted; };
+	inline double getError() { return error; };
+	inline double getRankCorrelation() { return correlation; };
+	int explore;				///< Networks outside the best fraction evaluated by each screen
+private:
+	int numFeatures;
+	double lambda;				///< Ridge regularization
+	double forget;				///< Weight of the past at each new observation
+	int inputSize;				///< Number of weights of the Networks seen so far
+	std::vector<double> projection;	///< numFeatures x inputSize, empty if not needed
+	std::vector<double> gram;	///< Discounted X'X, (numFeatures + 1) squared
+	std::vector<double> moment;	///< Discounted X'y
+	std::vector<double> coeff;
+	bool stale;					///< Whether coeff must be recomputed
+	int observations;
+	int predicted;
+	double error;				///< Mean absolute error of the last screen
+	double correlation;			///< Spearman rank correlation of the last screen
+	void features(Network*, std::vector<double>&);
+	void solve();
+	void credit(Network*, double);
+};
+
+}
+
+#endif
@@ -0,0 +1,47 @@
+#include "TypeDescriptor.hpp"
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+namespace ESP {
+
+static std::vector<const TypeDescriptor*>& registry() {
+	static std::vector<const TypeDescriptor*> types;
+	return types;
+}
+
+RegisterType::RegisterType(const TypeDescriptor& d) {
+	if (findType(d.type)) {
+		std::cerr << "Type " << d.type << " (" << d.name << ") registered twice; RegisterType::RegisterType" << std::endl;
+		abort();
+	}
+	registry().push_back(&d);
+}
+
+/*!
+ * Find a registered descriptor by type, 0 if there is none
+ */
+const TypeDescriptor* findType(int type) {
+	std::vector<const TypeDescriptor*>& types = registry();
+	for (unsigned int i = 0; i < types.size(); ++i) {
+		if (types[i]->type == type) {
+			return types[i];
+		}
+	}
+	return 0;
+}
+
+/*!
+ * Find a registered descriptor by name, 0 if there is none
+ */
+const TypeDescriptor* findType(const std::string& name) {
+	std::vector<const TypeDescriptor*>& types = registry();
+	for (unsigned int i = 0; i < types.size(); ++i) {
+		if (name == types[i]->name) {
+			return types[i];
+		}
+	}
+	return 0;
+}
+
+}
@@ -0,0 +1,30 @@
+#ifndef _TYPEDESCRIPTOR_HPP_
+#define _TYPEDESCRIPTOR_HPP_
+
+#include <string>
+
+namespace ESP {
+
+/*!
+ * Static identity of a Neuron or Network class
+ * Each class defines one descriptor and returns it from
+ * getDescriptor, so the name and type of an object cost nothing per
+ * instance. Descriptors are registered by defining a RegisterType
+ * next to them, which lets saved files be mapped back to classes
+ */
+struct TypeDescriptor {
+	const char* name;
+	int type;
+};
+
+class RegisterType {
+public:
+	RegisterType(const TypeDescriptor&);
+};
+
+const TypeDescriptor* findType(int);
+const TypeDescriptor* findType(const std::string&);
+
+}
+
+#endif
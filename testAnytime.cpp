@@ -0,0 +1,177 @@
+#include "Anytime.hpp"
+#include "Environment.hpp"
+#include "Executor.hpp"
+#include "FeedForward.hpp"
+#include "Neuron.hpp"
+#include "Population.hpp"
+#include <iostream>
+#include <vector>
+#include <boost/thread/thread.hpp>
+
+using namespace ESP;
+
+/*!
+ * Environment whose evaluations take a set number of microseconds
+ */
+class Sleeper : public Environment {
+public:
+	Sleeper() : delay(0) { inputDimension = 2; outputDimension = 1; };
+	int delay;
+protected:
+	void setupInput(std::vector<double>& input) { input.assign(2, 0.0); };
+	double evalNet(Network*) {
+		boost::this_thread::sleep_for(boost::chrono::microseconds(delay));
+		return 1.0;
+	};
+};
+
+/*!
+ * Set every weight of net to value
+ */
+static void fill(Network& net, double value) {
+	for (int i = 0; i < net.getNumNeurons(); ++i) {
+		for (unsigned int j = 0; j < net.getNeuron(i)->getSize(); ++j) {
+			net.getNeuron(i)->setWeight(j, value);
+		}
+	}
+}
+
+/*!
+ * Whether every weight of net has the same value, which is returned in value
+ */
+static bool uniform(Network* net, double& value) {
+	value = net->getNeuron(0)->getWeight(0);
+	for (int i = 0; i < net->getNumNeurons(); ++i) {
+		for (unsigned int j = 0; j < net->getNeuron(i)->getSize(); ++j) {
+			if (net->getNeuron(i)->getWeight(j) != value) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static void publishAll(ChampionBuffer* buffer, Network* net, int count) {
+	for (int k = 1; k <= count; ++k) {
+		fill(*net, k);
+		buffer->publish(*net);
+	}
+}
+
+/*!
+ * Publish count champions from one thread while another acquires them
+ * Every acquired Network must be whole and no older than the previous one
+ */
+static int checkBuffer(int count) {
+	FeedForwardNetwork net(4, 6, 2);
+	net.create();
+	fill(net, 0.0);
+	ChampionBuffer buffer(net);
+	int failures = 0;
+	double value;
+	if (!uniform(buffer.acquire(), value) || value != 0.0) {
+		++failures;
+	}
+	boost::thread publisher(boost::bind(publishAll, &buffer, &net, count));
+	double last = 0.0;
+	int torn = 0, older = 0, distinct = 0;
+	while (last < count && torn < 100) {
+		if (!uniform(buffer.acquire(), value)) {
+			++torn;
+			continue;
+		}
+		older += value < last ? 1 : 0;
+		distinct += value > last ? 1 : 0;
+		last = value;
+	}
+	publisher.join();
+	std::cout << count << " champions published, " << distinct << " acquired: " << torn << " torn, " << older << " out of order; ";
+	return failures + torn + older + (uniform(buffer.acquire(), value) && value == count ? 0 : 1);
+}
+
+/*!
+ * Run generations of the controller on Environments that take delay
+ * microseconds per evaluation
+ */
+static void runGenerations(DeadlineController& controller, std::vector<NeuronPop*>& subpops, std::vector<Network*>& pool,
+						   std::vector<Environment*>& envts, Executor& executor, int delay, int generations) {
+	for (unsigned int e = 0; e < envts.size(); ++e) {
+		static_cast<Sleeper*>(envts[e])->delay = delay;
+	}
+	for (int g = 0; g < generations; ++g) {
+		controller.startGeneration();
+		int n = std::min((int)pool.size(), controller.getSubpopSize() * controller.getTrials());
+		std::vector<Network*> nets(pool.begin(), pool.begin() + n);
+		int done = controller.evaluate(nets, envts, executor);
+		for (unsigned int i = 0; i < subpops.size(); ++i) {
+			subpops[i]->qsortIndividuals();
+		}
+		controller.endGeneration(done);
+	}
+}
+
+/*!
+ * Number of subpopulations that are not of the controller's size
+ */
+static int wrongSize(DeadlineController& controller, std::vector<NeuronPop*>& subpops) {
+	int n = 0;
+	for (unsigned int i = 0; i < subpops.size(); ++i) {
+		n += (int)subpops[i]->getNumIndividuals() == controller.getSubpopSize() ? 0 : 1;
+	}
+	return n;
+}
+
+int main() {
+	int failures = checkBuffer(20000);
+	const double budget = 0.02;
+	const int start = 40;
+	boost::mt19937 rng(4);
+	FeedForwardNetwork exemplar(2, 3, 1);
+	Neuron neuron(exemplar.getGeneSize());
+	std::vector<NeuronPop*> subpops;
+	for (int i = 0; i < 3; ++i) {
+		subpops.push_back(new NeuronPop(start, neuron));
+		subpops.back()->create(rng);
+	}
+	DeadlineController controller(budget, subpops, rng);
+	controller.maxThreads = 2;
+	std::vector<Network*> pool;
+	for (int k = 0; k < controller.maxSize * controller.maxTrials; ++k) {
+		pool.push_back(exemplar.clone());
+		pool.back()->create(rng);
+	}
+	std::vector<Environment*> envts;
+	for (int e = 0; e < 2; ++e) {
+		envts.push_back(new Sleeper());
+	}
+	Executor executor(2);
+	// Slow evaluations: the subpopulations shrink and the generations fit the budget
+	runGenerations(controller, subpops, pool, envts, executor, 2000, 8);
+	int shrunk = controller.getSubpopSize();
+	double slowLatency = controller.getLatency();
+	failures += shrunk < start && slowLatency < 2 * budget ? 0 : 1;
+	failures += wrongSize(controller, subpops);
+	// Fast evaluations: they grow again
+	runGenerations(controller, subpops, pool, envts, executor, 20, 8);
+	int grown = controller.getSubpopSize();
+	failures += grown > shrunk ? 0 : 1;
+	failures += wrongSize(controller, subpops);
+	// Evaluations longer than the budget: never below one Neuron
+	controller.minSize = 0;
+	runGenerations(controller, subpops, pool, envts, executor, 100000, 2);
+	int smallest = controller.getSubpopSize();
+	failures += smallest == 1 ? 0 : 1;
+	failures += wrongSize(controller, subpops);
+	std::cout << "subpopulations of " << start << " shrink to " << shrunk << " at " << slowLatency * 1000 << " ms per generation, grow to "
+			  << grown << ", stop at " << smallest << " Neuron; budget " << budget * 1000 << " ms on " << controller.getThreads() << " threads" << std::endl;
+	for (unsigned int i = 0; i < pool.size(); ++i) {
+		delete pool[i];
+	}
+	for (unsigned int e = 0; e < envts.size(); ++e) {
+		delete envts[e];
+	}
+	for (unsigned int i = 0; i < subpops.size(); ++i) {
+		delete subpops[i];
+	}
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,56 @@
+#include "Archive.hpp"
+#include "Neuron.hpp"
+#include "Population.hpp"
+#include <iostream>
+#include <set>
+#include <fstream>
+#include <cstdio>
+#include <algorithm>
+#include <boost/random.hpp>
+
+using namespace ESP;
+
+int main() {
+	const int size = 20, genes = 6;
+	const char* fname = "testArchive.esp";
+	boost::mt19937 rng(5);
+	Neuron exemplar(genes);
+	NeuronPop saved(size, exemplar);
+	saved.create(rng);
+	if (!PopulationArchive::save(saved, fname)) {
+		return 1;
+	}
+	// Pretend the first Neuron comes from a run that got far ahead of
+	// this one: its ID sits after the 16 byte header
+	const int foreign = 1000000;
+	std::fstream patch(fname, std::fstream::in | std::fstream::out | std::fstream::binary);
+	patch.seekp(16);
+	patch.write(reinterpret_cast<const char*>(&foreign), sizeof(int));
+	patch.close();
+	int failures = 0;
+	PopulationArchive archive(fname);
+	NeuronPop first(size, exemplar), second(size, exemplar);
+	archive.load(first);
+	archive.load(second);
+	std::set<int> ids;
+	int same = 0, kept = 0;
+	for (int i = 0; i < size; ++i) {
+		same += std::equal(saved.getIndividual(i)->getWeights(), saved.getIndividual(i)->getWeights() + genes,
+						   second.getIndividual(i)->getWeights()) ? 1 : 0;
+		kept += first.getIndividual(i)->getID() == archive.getID(i) ? 1 : 0;
+		ids.insert(first.getIndividual(i)->getID());
+		ids.insert(second.getIndividual(i)->getID());
+	}
+	// Fresh Neurons must not collide with any archived ID either
+	Neuron fresh(genes);
+	fresh.create(rng);
+	ids.insert(fresh.getID());
+	failures += fresh.getID() > foreign ? 0 : 1;
+	std::cout << "Archive of " << size << " Neurons loaded twice: " << same << " copies identical, "
+			  << kept << " archived IDs kept, " << ids.size() << " distinct IDs" << std::endl;
+	failures += same == size ? 0 : 1;
+	failures += kept == size ? 0 : 1;
+	failures += (int)ids.size() == 2 * size + 1 ? 0 : 1;
+	std::remove(fname);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,121 @@
+#include "BatchEnvironment.hpp"
+#include "FeedForward.hpp"
+#include "Neuron.hpp"
+#include "Population.hpp"
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <boost/random.hpp>
+
+using namespace ESP;
+
+/*!
+ * Lanes drift by the output of the Network and are rewarded for
+ * staying near the origin; a lane ends once it drifts too far
+ */
+static double startOf(int lane, int lanes) {
+	return -1.0 + 2.0 * lane / (lanes - 1);
+}
+
+static double reward(double& x, double output) {
+	x += output - 0.5;
+	return 1.0 - fabs(x);
+}
+
+class DriftLanes : public BatchEnvironment {
+public:
+	DriftLanes(int lanes, int steps) : BatchEnvironment(lanes, steps), x(lanes) { inputDimension = 2; outputDimension = 1; };
+protected:
+	// The lanes start in the same places on every episode
+	void resetLanes(const unsigned int*) {
+		for (int l = 0; l < lanes; ++l) {
+			x[l] = startOf(l, lanes);
+		}
+	};
+	void setupInputs(std::vector<double>& inputs) {
+		for (int l = 0; l < lanes; ++l) {
+			inputs[2 * l] = x[l];
+			inputs[2 * l + 1] = 1.0 - x[l];
+		}
+	};
+	void stepLanes(const std::vector<double>& outputs) {
+		for (int l = 0; l < lanes; ++l) {
+			double r = reward(x[l], outputs[l]);
+			if (alive[l]) {
+				laneFitness[l] += r;
+				alive[l] = fabs(x[l]) <= 1.5;
+			}
+		}
+	};
+private:
+	std::vector<double> x;
+};
+
+/*!
+ * The same episodes run one at a time through Network::activate
+ */
+class DriftSingle : public Environment {
+public:
+	DriftSingle(int l, int s) : lanes(l), steps(s) { inputDimension = 2; outputDimension = 1; };
+protected:
+	void setupInput(std::vector<double>&) {};
+	double evalNet(Network* net) {
+		std::vector<double> in(2), out(1);
+		double total = 0.0;
+		for (int l = 0; l < lanes; ++l) {
+			double x = startOf(l, lanes);
+			for (int s = 0; s < steps; ++s) {
+				in[0] = x;
+				in[1] = 1.0 - x;
+				net->activate(in, out);
+				total += reward(x, out[0]);
+				if (fabs(x) > 1.5) {
+					break;
+				}
+			}
+		}
+		return total / lanes;
+	};
+private:
+	int lanes, steps;
+};
+
+int main() {
+	const int hidden = 5, size = 8, lanes = 16, steps = 50, rounds = 200;
+	boost::mt19937 rng(7);
+	FeedForwardNetwork net(2, hidden, 1);
+	Neuron exemplar(net.getGeneSize());
+	std::vector<NeuronPop*> subpops;
+	for (int i = 0; i < hidden; ++i) {
+		subpops.push_back(new NeuronPop(size, exemplar));
+		subpops.back()->create(rng);
+		net.setNeuron(subpops.back()->getIndividual(0), i);
+	}
+	DriftLanes batch(lanes, steps);
+	DriftSingle single(lanes, steps);
+	boost::uniform_int<> unit(0, hidden - 1), pick(0, size - 1), change(0, 2);
+	boost::uniform_real<> noise(-1.0, 1.0);
+	int differ = 0;
+	for (int r = 0; r < rounds; ++r) {
+		// The packed weights must follow every kind of change between evaluations
+		int i = unit(rng);
+		switch (change(rng)) {
+		case 0:
+			net.setNeuron(subpops[i]->getIndividual(pick(rng)), i);
+			break;
+		case 1:
+			net.getNeuron(i)->setWeight(0, net.getNeuron(i)->getWeight(0) + noise(rng));
+			break;
+		default:
+			net.getNeuron(i)->lesioned = !net.getNeuron(i)->lesioned;
+		}
+		double a = batch.evaluateNetwork(&net), b = single.evaluateNetwork(&net);
+		differ += fabs(a - b) <= 1e-12 * (1.0 + fabs(b)) ? 0 : 1;
+	}
+	std::cout << rounds << " evaluations of a changing " << hidden << " unit Network on " << lanes
+			  << " lanes: " << differ << " differ between batched and single activation" << std::endl;
+	for (int i = 0; i < hidden; ++i) {
+		delete subpops[i];
+	}
+	return differ ? 1 : 0;
+}
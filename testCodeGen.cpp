@@ -0,0 +1,43 @@
+#include "FeedForward.hpp"
+#include "SparseNetwork.hpp"
+#include "CodeGen.hpp"
+#include <iostream>
+#include <cstdlib>
+
+using namespace ESP;
+
+/*!
+ * Export a random Network with its harness, then compile and run
+ * the harness, which fails if the exported forward pass differs
+ * from Network::activate
+ */
+int main() {
+	FeedForwardNetwork net(4, 3, 2);
+	net.create();
+	std::srand(1);
+	std::vector<std::vector<double> > samples(50, std::vector<double>(4));
+	for (unsigned int s = 0; s < samples.size(); ++s) {
+		for (int j = 0; j < 4; ++j) {
+			samples[s][j] = 2.0 * std::rand() / RAND_MAX - 1.0;
+		}
+	}
+	if (!exportNetwork(&net, "testCodeGenNet.hpp", "exported") ||
+		!exportHarness(&net, "testCodeGenHarness.cpp", "testCodeGenNet.hpp", "exported", samples)) {
+		std::cout << "Export failed" << std::endl;
+		return 1;
+	}
+	// Networks of another layout and samples of the wrong size are refused
+	SparseNetwork sparse(4, 3, 2, 3);
+	sparse.create();
+	std::vector<std::vector<double> > bad(1, std::vector<double>(3));
+	if (exportNetwork(&sparse, "testCodeGenSparse.hpp", "sparse") ||
+		exportHarness(&net, "testCodeGenBad.cpp", "testCodeGenNet.hpp", "exported", bad)) {
+		std::cout << "Export accepted a bad Network or sample" << std::endl;
+		return 1;
+	}
+	int status = system("g++ -std=c++11 -o testCodeGenHarness testCodeGenHarness.cpp && ./testCodeGenHarness");
+	std::remove("testCodeGenNet.hpp");
+	std::remove("testCodeGenHarness.cpp");
+	std::remove("testCodeGenHarness");
+	return status == 0 ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#include "Diversity.hpp"
+#include "Neuron.hpp"
+#include "Population.hpp"
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <boost/random.hpp>
+
+using namespace ESP;
+
+/*!
+ * Mean squared distance over all pairs of distinct individuals
+ */
+static double bruteForceDiversity(NeuronPop& pop) {
+	int n = pop.getNumIndividuals();
+	double total = 0.0;
+	for (int a = 0; a < n; ++a) {
+		for (int b = 0; b < n; ++b) {
+			if (a == b) {
+				continue;
+			}
+			for (unsigned int j = 0; j < pop.getIndividual(a)->getSize(); ++j) {
+				double d = pop.getIndividual(a)->getWeight(j) - pop.getIndividual(b)->getWeight(j);
+				total += d * d;
+			}
+		}
+	}
+	return total / (n * (n - 1));
+}
+
+int main() {
+	const int size = 40, genes = 12, generations = 30;
+	boost::mt19937 rng(3);
+	Neuron exemplar(genes);
+	NeuronPop pop(size, exemplar);
+	pop.create(rng);
+	DiversityMonitor monitor(pop, 10, 0.0);
+	boost::uniform_int<> pick(0, size - 1);
+	boost::uniform_real<> noise(-1.0, 1.0);
+	double worst = 0.0;
+	for (int g = 0; g < generations; ++g) {
+		// The operators of a generation: mutation, copies and single weight writes
+		pop.mutate(0.5, rng);
+		*pop.getIndividual(pick(rng)) = *pop.getIndividual(pick(rng));
+		Neuron* n = pop.getIndividual(pick(rng));
+		n->setWeight(0, n->getWeight(0) + noise(rng));
+		Neuron* best = pop.getIndividual(pick(rng));
+		std::vector<double> champion(best->getWeights(), best->getWeights() + genes);
+		// Negative fitness that stops improving after generation 18, so
+		// the only burst comes from stagnation at generation 28
+		bool burst = monitor.update(best, g < 19 ? -100.0 + g : -100.0);
+		if (burst && std::vector<double>(best->getWeights(), best->getWeights() + genes) != champion) {
+			std::cout << "Burst mutation changed the champion" << std::endl;
+			return 1;
+		}
+		monitor.refresh();
+		double exact = bruteForceDiversity(pop);
+		worst = std::max(worst, fabs(monitor.getDiversity() - exact) / exact);
+	}
+	std::cout << "Diversity of " << size << " Neurons over " << generations << " generations, "
+			  << monitor.getBursts() << " bursts: maximum relative error " << worst << std::endl;
+	return worst < 1e-9 && monitor.getBursts() == 1 ? 0 : 1;
+}
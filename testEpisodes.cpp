@@ -0,0 +1,158 @@
+#include "BatchEnvironment.hpp"
+#include "Environment.hpp"
+#include "Executor.hpp"
+#include "FeedForward.hpp"
+#include "NeuroEvolution.hpp"
+#include "Numa.hpp"
+#include "Refine.hpp"
+#include "Surrogate.hpp"
+#include <iostream>
+#include <map>
+#include <vector>
+
+using namespace ESP;
+
+typedef std::map<Network*, std::vector<unsigned int> > Episodes;
+
+/*!
+ * Environment that records the episode seeds each Network is evaluated on
+ * Unseeded evaluations are counted instead
+ */
+class Recorder : public Environment {
+public:
+	Recorder() : fresh(0) { inputDimension = 2; outputDimension = 1; };
+	Episodes seen;
+	int fresh;
+protected:
+	void setupInput(std::vector<double>& input) { input.assign(2, 0.0); };
+	double evalNet(Network* net) {
+		if (hasEpisodeSeed()) {
+			seen[net].push_back(getEpisodeSeed());
+		} else {
+			++fresh;
+		}
+		return getEpisodeSeed() % 100;
+	};
+};
+
+/*!
+ * BatchEnvironment that records the seed its lanes are reset from
+ */
+class BatchRecorder : public BatchEnvironment {
+public:
+	BatchRecorder() : BatchEnvironment(4, 3), fresh(0) { inputDimension = 2; outputDimension = 1; };
+	std::vector<unsigned int> seen;
+	int fresh;
+protected:
+	void resetLanes(const unsigned int* seed) {
+		if (seed) {
+			seen.push_back(*seed);
+		} else {
+			++fresh;
+		}
+	};
+	void setupInputs(std::vector<double>& inputs) { std::fill(inputs.begin(), inputs.end(), 0.0); };
+	void stepLanes(const std::vector<double>&) {};
+};
+
+/*!
+ * Number of Networks not evaluated on exactly the given episodes
+ */
+static int mismatches(Episodes& seen, std::vector<Network*>& nets, const std::vector<unsigned int>& seeds) {
+	int n = 0;
+	for (unsigned int i = 0; i < nets.size(); ++i) {
+		n += seen[nets[i]] == seeds ? 0 : 1;
+	}
+	return n;
+}
+
+static int report(const char* path, int wrong, int fresh) {
+	std::cout << path << ": " << wrong << " differ";
+	if (fresh) {
+		std::cout << ", " << fresh << " fresh episodes";
+	}
+	std::cout << "; ";
+	return wrong || fresh ? 1 : 0;
+}
+
+int main() {
+	const int episodes = 3;
+	boost::mt19937 stream(9);
+	Recorder envt;
+	NeuroEvolution ne(envt, &stream);
+	ne.newEpisodeSeeds(episodes);
+	std::vector<Network*> nets;
+	for (int i = 0; i < 2; ++i) {
+		nets.push_back(new FeedForwardNetwork(2, 3, 1));
+		nets.back()->create(stream);
+	}
+	int failures = 0;
+	// NeuroEvolution
+	for (unsigned int i = 0; i < nets.size(); ++i) {
+		ne.evaluateEpisodes(nets[i]);
+	}
+	failures += report("NeuroEvolution", mismatches(envt.seen, nets, ne.episodeSeeds), envt.fresh);
+	// Surrogate, untrained so it evaluates every Network
+	envt.seen.clear();
+	Surrogate surrogate;
+	surrogate.screen(nets, 0.5, envt);
+	failures += report("Surrogate", mismatches(envt.seen, nets, ne.episodeSeeds), envt.fresh);
+	// NumaExecutor, two Environments per node sharing the NeuroEvolution
+	NumaExecutor numa(2);
+	std::vector<std::vector<Environment*> > nodeEnvts(numa.getNumNodes());
+	std::vector<Recorder*> recorders;
+	for (int n = 0; n < numa.getNumNodes(); ++n) {
+		for (int w = 0; w < 2; ++w) {
+			recorders.push_back(new Recorder());
+			recorders.back()->setNetPtr(&ne);
+			nodeEnvts[n].push_back(recorders.back());
+		}
+	}
+	numa.evaluate(nets, nodeEnvts);
+	Episodes merged;
+	int fresh = 0;
+	for (unsigned int r = 0; r < recorders.size(); ++r) {
+		for (Episodes::iterator i = recorders[r]->seen.begin(); i != recorders[r]->seen.end(); ++i) {
+			merged[i->first].insert(merged[i->first].end(), i->second.begin(), i->second.end());
+		}
+		fresh += recorders[r]->fresh;
+		recorders[r]->seen.clear();
+		recorders[r]->fresh = 0;
+	}
+	failures += report("NumaExecutor", mismatches(merged, nets, ne.episodeSeeds), fresh);
+	// Refiner, whose parent and offspring share the episodes of a step
+	Executor executor(2);
+	std::vector<Environment*> refineEnvts(recorders.begin(), recorders.begin() + 2);
+	Refiner refiner(nets[0], 6, refineEnvts, executor, 5);
+	refiner.trials = episodes;
+	recorders[0]->seen.clear();
+	refiner.step();
+	merged.clear();
+	std::vector<Network*> family;
+	for (int r = 0; r < 2; ++r) {
+		for (Episodes::iterator i = recorders[r]->seen.begin(); i != recorders[r]->seen.end(); ++i) {
+			merged[i->first] = i->second;
+			family.push_back(i->first);
+		}
+	}
+	std::vector<unsigned int> step = merged[family[0]];
+	int wrong = mismatches(merged, family, step) + (family.size() == 7 && step.size() == episodes ? 0 : 1);
+	failures += report("Refiner", wrong, recorders[0]->fresh + recorders[1]->fresh);
+	// BatchEnvironment
+	BatchRecorder batch;
+	batch.setNetPtr(&ne);
+	for (unsigned int i = 0; i < nets.size(); ++i) {
+		batch.evaluateEpisodes(nets[i]);
+	}
+	std::vector<unsigned int> twice(ne.episodeSeeds);
+	twice.insert(twice.end(), ne.episodeSeeds.begin(), ne.episodeSeeds.end());
+	failures += report("BatchEnvironment", batch.seen == twice ? 0 : 1, batch.fresh);
+	std::cout << "2 Networks on " << episodes << " common episodes" << std::endl;
+	for (unsigned int r = 0; r < recorders.size(); ++r) {
+		delete recorders[r];
+	}
+	for (unsigned int i = 0; i < nets.size(); ++i) {
+		delete nets[i];
+	}
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+#include "Experiment.hpp"
+#include "Diversity.hpp"
+#include "Neuron.hpp"
+#include "Population.hpp"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <boost/bind/bind.hpp>
+
+using namespace ESP;
+
+/*!
+ * Evolves a subpopulation towards the origin
+ * Uses every random operator of a run with the run's stream and
+ * evaluates the Neurons of a generation in parallel
+ */
+class OriginRun : public Run {
+public:
+	OriginRun(unsigned int s, std::ostream& out) : Run(s, out), exemplar(genes), pop(size, exemplar), fitness(size) {
+		pop.create(rng);
+		monitor = new DiversityMonitor(pop, 4, 0.0);
+	};
+	~OriginRun() { delete monitor; };
+	bool generation() {
+		pop.mutate(0.5, rng);
+		std::vector<boost::function<void()> > tasks;
+		for (int i = 0; i < size; ++i) {
+			tasks.push_back(boost::bind(&OriginRun::evaluate, this, i));
+		}
+		executor->runAll(tasks);
+		int best = 0, worst = 0;
+		for (int i = 1; i < size; ++i) {
+			best = fitness[i] > fitness[best] ? i : best;
+			worst = fitness[i] < fitness[worst] ? i : worst;
+		}
+		Neuron* child = pop.getIndividual(best)->perturb(0.1, rng);
+		*pop.getIndividual(worst) = *child;
+		delete child;
+		*pop.getIndividual(worst) = *pop.selectRndIndividual(-1, rng);
+		monitor->update(pop.getIndividual(best), fitness[best], rng);
+		if (generations + 1 < 40) {
+			return true;
+		}
+		results.precision(17);
+		for (int i = 0; i < size; ++i) {
+			for (int j = 0; j < genes; ++j) {
+				results << pop.getIndividual(i)->getWeight(j) << " ";
+			}
+		}
+		return false;
+	};
+private:
+	static const int size = 16, genes = 5;
+	Neuron exemplar;
+	NeuronPop pop;
+	DiversityMonitor* monitor;
+	std::vector<double> fitness;
+	void evaluate(int i) {
+		double f = 0.0;
+		for (int j = 0; j < genes; ++j) {
+			f -= pop.getIndividual(i)->getWeight(j) * pop.getIndividual(i)->getWeight(j);
+		}
+		fitness[i] = f;
+	};
+};
+
+/*!
+ * Final weights of every run, with the runs spread over threads
+ */
+static std::vector<std::string> runAll(int threads, int runs) {
+	std::vector<std::ostringstream*> out;
+	std::vector<Run*> r;
+	ExperimentRunner runner(threads);
+	for (int i = 0; i < runs; ++i) {
+		out.push_back(new std::ostringstream);
+		r.push_back(new OriginRun(100 + i, *out.back()));
+		runner.add(r.back());
+	}
+	runner.run();
+	std::vector<std::string> results;
+	for (int i = 0; i < runs; ++i) {
+		results.push_back(out[i]->str());
+		delete r[i];
+		delete out[i];
+	}
+	return results;
+}
+
+int main() {
+	const int runs = 6;
+	std::vector<std::string> one = runAll(1, runs);
+	int same = 0;
+	for (int threads = 2; threads <= 8; threads *= 2) {
+		std::vector<std::string> many = runAll(threads, runs);
+		for (int i = 0; i < runs; ++i) {
+			same += !one[i].empty() && many[i] == one[i] ? 1 : 0;
+		}
+	}
+	std::cout << "Runs reproduced on 2, 4 and 8 threads: " << same << " of " << 3 * runs << std::endl;
+	return same == 3 * runs ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+#include "FeedForward.hpp"
+#include "Incremental.hpp"
+#include "Neuron.hpp"
+#include "Population.hpp"
+#include <iostream>
+#include <cmath>
+#include <vector>
+
+using namespace ESP;
+
+/*!
+ * Environment that is never solved, so the controller only bursts
+ */
+class Unsolved : public Environment {
+public:
+	Unsolved() { inputDimension = 2; outputDimension = 1; tolerance = 1e9; };
+protected:
+	void setupInput(std::vector<double>& input) { input.assign(2, 0.0); };
+	double evalNet(Network*) { return 0.0; };
+};
+
+int main() {
+	const int hidden = 3, size = 10, champion = 4;
+	boost::mt19937 rng(1);
+	FeedForwardNetwork best(2, hidden, 1);
+	Neuron exemplar(best.getGeneSize());
+	std::vector<NeuronPop*> subpops;
+	for (int i = 0; i < hidden; ++i) {
+		subpops.push_back(new NeuronPop(size, exemplar));
+		subpops.back()->create(rng);
+		best.setNeuron(subpops.back()->getIndividual(champion), i);
+	}
+	std::vector<std::vector<double> > before(hidden);
+	for (int i = 0; i < hidden; ++i) {
+		const double* w = best.getNeuron(i)->getWeights();
+		before[i].assign(w, w + best.getGeneSize());
+	}
+	Unsolved envt;
+	IncrementalController controller(envt, 1);
+	controller.update(&best, subpops);
+	controller.update(&best, subpops);
+	int failures = 0;
+	int kept = 0, centred = 0;
+	for (int i = 0; i < hidden; ++i) {
+		kept += std::vector<double>(best.getNeuron(i)->getWeights(), best.getNeuron(i)->getWeights() + best.getGeneSize()) == before[i] ? 1 : 0;
+		for (int k = 0; k < size; ++k) {
+			bool near = true;
+			for (int j = 0; j < best.getGeneSize(); ++j) {
+				near = near && fabs(subpops[i]->getIndividual(k)->getWeight(j) - before[i][j]) <= 10.0;
+			}
+			centred += near ? 1 : 0;
+		}
+	}
+	std::cout << "Burst mutation: " << kept << " of " << hidden << " champion Neurons kept, "
+			  << centred << " of " << hidden * size << " Neurons within the Cauchy cut of the champion" << std::endl;
+	failures += kept == hidden ? 0 : 1;
+	failures += centred == hidden * size ? 0 : 1;
+	for (int i = 0; i < hidden; ++i) {
+		delete subpops[i];
+	}
+	return failures ? 1 : 0;
+}
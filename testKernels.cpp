@@ -0,0 +1,103 @@
+#include "NeuroEvolution.hpp"
+#include "Environment.hpp"
+#include "Neuron.hpp"
+#include "Population.hpp"
+#include <iostream>
+#include <vector>
+#include <boost/random.hpp>
+
+using namespace ESP;
+
+/*!
+ * Environment that only gives the NeuroEvolution its dimensions
+ */
+class Idle : public Environment {
+public:
+	Idle() { inputDimension = 2; outputDimension = 1; };
+protected:
+	void setupInput(std::vector<double>& input) { input.assign(2, 0.0); };
+	double evalNet(Network*) { return 0.0; };
+};
+
+/*!
+ * Number of rows whose weights or parents differ between the two subpopulations
+ */
+static int differ(NeuronPop& a, NeuronPop& b) {
+	int rows = 0;
+	for (unsigned int i = 0; i < a.getNumIndividuals(); ++i) {
+		Neuron* x = a.getIndividual(i);
+		Neuron* y = b.getIndividual(i);
+		bool same = x->parent1 == y->parent1 && x->parent2 == y->parent2;
+		for (unsigned int j = 0; j < x->getSize(); ++j) {
+			same = same && x->getWeight(j) == y->getWeight(j);
+		}
+		rows += same ? 0 : 1;
+	}
+	return rows;
+}
+
+int main() {
+	const int size = 40, genes = 13, rounds = 10;
+	boost::mt19937 stream;
+	Idle envt;
+	NeuroEvolution ne(envt, &stream);
+	Neuron exemplar(genes);
+	NeuronPop single(size, exemplar);
+	NeuronPop kernel(size, exemplar);
+	single.create(stream);
+	kernel.create(stream);
+	for (int i = 0; i < size; ++i) {
+		*kernel.getIndividual(i) = *single.getIndividual(i);
+	}
+	// Parents from the top quarter, children into the bottom half
+	std::vector<Mating> matings;
+	boost::uniform_int<> parent(0, size / 4 - 1);
+	for (int c = size / 2; c < size; c += 2) {
+		Mating m = { parent(stream), parent(stream), c, c + 1 };
+		while (m.parent2 == m.parent1) {
+			m.parent2 = parent(stream);
+		}
+		matings.push_back(m);
+	}
+	int failures = 0;
+	const char* names[] = { "crossoverOnePoint", "crossoverArithmetic", "crossoverEir", "mutate" };
+	for (int op = 0; op < 4; ++op) {
+		int rows = 0;
+		for (int r = 0; r < rounds; ++r) {
+			unsigned int seed = 100 * op + r;
+			stream.seed(seed);
+			if (op == 3) {
+				single.mutate(0.5, stream);
+			} else {
+				for (unsigned int m = 0; m < matings.size(); ++m) {
+					Neuron* p1 = single.getIndividual(matings[m].parent1);
+					Neuron* p2 = single.getIndividual(matings[m].parent2);
+					Neuron* c1 = single.getIndividual(matings[m].child1);
+					Neuron* c2 = single.getIndividual(matings[m].child2);
+					if (op == 0) {
+						ne.crossoverOnePoint(p1, p2, c1, c2);
+					} else if (op == 1) {
+						ne.crossoverArithmetic(p1, p2, c1, c2);
+					} else {
+						ne.crossoverEir(p1, p2, c1, c2);
+					}
+				}
+			}
+			stream.seed(seed);
+			if (op == 0) {
+				ne.crossoverOnePoint(kernel.individuals, matings);
+			} else if (op == 1) {
+				ne.crossoverArithmetic(kernel.individuals, matings);
+			} else if (op == 2) {
+				ne.crossoverEir(kernel.individuals, matings);
+			} else {
+				ne.mutate(kernel.individuals, kernel.getNumBreed() * 2, 0.5);
+			}
+			rows += differ(single, kernel);
+		}
+		std::cout << names[op] << ": " << rows << " of " << rounds * size << " rows differ; ";
+		failures += rows ? 1 : 0;
+	}
+	std::cout << "subpopulation kernels against the per-Neuron operators" << std::endl;
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+#include "FeedForward.hpp"
+#include "NeuroEvolution.hpp"
+#include "Neuron.hpp"
+#include "Population.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+using namespace ESP;
+
+/*!
+ * Environment reporting two objectives, the Network's output on a
+ * fixed input and its negative
+ */
+class TwoObjectives : public Environment {
+public:
+	TwoObjectives() { inputDimension = 2; outputDimension = 1; };
+protected:
+	void setupInput(std::vector<double>& input) { input.assign(2, 0.5); };
+	double evalNet(Network* net) {
+		std::vector<double> input, output;
+		setupInput(input);
+		net->activate(input, output);
+		objectives.assign(2, output[0]);
+		objectives[1] = -output[0];
+		return output[0];
+	};
+};
+
+/*!
+ * Front of each Neuron by repeatedly peeling off the non-dominated set
+ */
+static void bruteForceRanks(std::vector<Neuron*>& ind, std::vector<int>& rank) {
+	int n = ind.size();
+	rank.assign(n, -1);
+	int assigned = 0;
+	for (int front = 0; assigned < n; ++front) {
+		std::vector<int> current;
+		for (int p = 0; p < n; ++p) {
+			if (rank[p] >= 0) {
+				continue;
+			}
+			bool dominated = false;
+			for (int q = 0; q < n && !dominated; ++q) {
+				if (q == p || (rank[q] >= 0 && rank[q] < front)) {
+					continue;
+				}
+				if (ind[p]->getNumObjectives() == 0) {
+					dominated = ind[q]->getNumObjectives() > 0;
+					continue;
+				}
+				if (ind[q]->getNumObjectives() == 0) {
+					continue;
+				}
+				bool better = false, worse = false;
+				for (int j = 0; j < ind[p]->getNumObjectives(); ++j) {
+					better = better || ind[q]->getObjective(j) > ind[p]->getObjective(j);
+					worse = worse || ind[q]->getObjective(j) < ind[p]->getObjective(j);
+				}
+				dominated = better && !worse;
+			}
+			if (!dominated) {
+				current.push_back(p);
+			}
+		}
+		for (unsigned int i = 0; i < current.size(); ++i) {
+			rank[current[i]] = front;
+		}
+		assigned += current.size();
+	}
+}
+
+int main() {
+	int failures = 0;
+	// Objectives reach the Neurons through Network::addFitness
+	TwoObjectives envt;
+	NeuroEvolution ne(envt);
+	FeedForwardNetwork net(2, 3, 1);
+	net.create();
+	double fit = envt.evaluateNetwork(&net);
+	net.addFitness();
+	if (net.getNeuron(0)->getNumObjectives() != 2 || net.getNeuron(0)->getObjective(0) != fit) {
+		std::cout << "Network::addFitness did not pass the objectives on" << std::endl;
+		++failures;
+	}
+	// Ranks against brute force, with a tenth of the Neurons unevaluated
+	std::srand(1);
+	std::vector<Neuron*> ind(3000);
+	for (unsigned int i = 0; i < ind.size(); ++i) {
+		ind[i] = new Neuron(1);
+		if (i % 10 == 0) {
+			continue;
+		}
+		std::vector<double> obj(3);
+		for (int j = 0; j < 3; ++j) {
+			obj[j] = std::rand() % 50;
+		}
+		ind[i]->addObjectives(obj);
+		ind[i]->addFitness(0.0);
+	}
+	std::vector<int> rank, expected;
+	clock_t start = clock();
+	nondominatedSort(ind, rank);
+	double ms = 1000.0 * (clock() - start) / CLOCKS_PER_SEC;
+	bruteForceRanks(ind, expected);
+	if (rank != expected) {
+		std::cout << "nondominatedSort differs from brute force" << std::endl;
+		++failures;
+	}
+	std::cout << "nondominatedSort of " << ind.size() << " Neurons with 3 objectives: " << ms << " ms" << std::endl;
+	nsgaSort(ind);
+	for (unsigned int i = ind.size() - ind.size() / 10; i < ind.size(); ++i) {
+		if (ind[i]->getNumObjectives() != 0) {
+			std::cout << "Unevaluated Neurons are not ranked last" << std::endl;
+			++failures;
+			break;
+		}
+	}
+	for (unsigned int i = 0; i < ind.size(); ++i) {
+		delete ind[i];
+	}
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,84 @@
+#include "Novelty.hpp"
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <boost/random.hpp>
+
+using namespace ESP;
+
+/*!
+ * Mean distance to the k nearest of points, by a full scan
+ */
+static double bruteForce(const std::vector<double>& points, const double* q, int dim, int k) {
+	int n = points.size() / dim;
+	std::vector<double> dist(n);
+	for (int i = 0; i < n; ++i) {
+		double sum = 0.0;
+		for (int d = 0; d < dim; ++d) {
+			double diff = q[d] - points[i * dim + d];
+			sum += diff * diff;
+		}
+		dist[i] = sum;
+	}
+	int m = std::min(k, n);
+	std::partial_sort(dist.begin(), dist.begin() + m, dist.end());
+	double sum = 0.0;
+	for (int i = 0; i < m; ++i) {
+		sum += sqrt(dist[i]);
+	}
+	return sum / m;
+}
+
+int main() {
+	const int dim = 3, k = 5, queries = 400;
+	boost::mt19937 rng(11);
+	boost::uniform_real<> coord(-1.0, 1.0);
+	boost::uniform_int<> pick(0, 2);
+	NoveltyArchive archive(dim, k, 0.0, 4);
+	std::vector<double> points, b(dim);
+	// Random points, many of them archived several times, a cluster
+	// larger than k of one repeated point and points on a lattice, so
+	// that many coordinates equal the splitting values
+	for (int i = 0; i < 600; ++i) {
+		if (i % 50 == 0) {
+			for (int d = 0; d < dim; ++d) {
+				b[d] = 0.25;
+			}
+			for (int r = 0; r < 3 * k; ++r) {
+				archive.insert(b);
+				points.insert(points.end(), b.begin(), b.end());
+			}
+		}
+		for (int d = 0; d < dim; ++d) {
+			b[d] = i % 3 == 0 ? 0.5 * pick(rng) : coord(rng);
+		}
+		int copies = 1 + pick(rng);
+		for (int r = 0; r < copies; ++r) {
+			archive.insert(b);
+			points.insert(points.end(), b.begin(), b.end());
+		}
+	}
+	// Random queries, archived points and lattice points
+	std::vector<double> batch(queries * dim);
+	int archived = points.size() / dim;
+	boost::uniform_int<> any(0, archived - 1);
+	for (int q = 0; q < queries; ++q) {
+		int from = any(rng);
+		for (int d = 0; d < dim; ++d) {
+			batch[q * dim + d] = q % 3 == 0 ? coord(rng) : q % 3 == 1 ? points[from * dim + d] : 0.5 * pick(rng);
+		}
+	}
+	std::vector<double> batched;
+	archive.novelty(batch, batched);
+	int wrongSingle = 0, wrongBatched = 0;
+	for (int q = 0; q < queries; ++q) {
+		double exact = bruteForce(points, &batch[q * dim], dim, k);
+		std::vector<double> one(batch.begin() + q * dim, batch.begin() + (q + 1) * dim);
+		wrongSingle += fabs(archive.novelty(one) - exact) <= 1e-12 * (1.0 + exact) ? 0 : 1;
+		wrongBatched += fabs(batched[q] - exact) <= 1e-12 * (1.0 + exact) ? 0 : 1;
+	}
+	std::cout << queries << " " << k << "-nearest queries in an archive of " << archive.size() << " behaviors with duplicates: "
+			  << wrongSingle << " single and " << wrongBatched << " batched differ from brute force" << std::endl;
+	return wrongSingle || wrongBatched || (int)archive.size() != archived ? 1 : 0;
+}
@@ -0,0 +1,46 @@
+#include "FeedForward.hpp"
+#include "Neuron.hpp"
+#include "Quantized.hpp"
+#include <iostream>
+#include <cstdlib>
+
+using namespace ESP;
+
+/*!
+ * Maximum output error of the quantized copy of net on random inputs
+ */
+static double quantizationError(FeedForwardNetwork& net) {
+	QuantizedNetwork q(&net);
+	std::vector<std::vector<double> > samples(1000, std::vector<double>(net.numInputs));
+	for (unsigned int s = 0; s < samples.size(); ++s) {
+		for (int j = 0; j < net.numInputs; ++j) {
+			samples[s][j] = 2.0 * std::rand() / RAND_MAX - 1.0;
+		}
+	}
+	return QuantizedNetwork::maxError(&net, q, samples);
+}
+
+int main() {
+	int failures = 0;
+	std::srand(1);
+	FeedForwardNetwork net(10, 8, 3);
+	net.create();
+	// Same range as Neuron::create, but reproducible
+	for (int i = 0; i < net.getNumNeurons(); ++i) {
+		for (int j = 0; j < net.getGeneSize(); ++j) {
+			net.getNeuron(i)->setWeight(j, 12.0 * std::rand() / RAND_MAX - 6.0);
+		}
+	}
+	double err = quantizationError(net);
+	std::cout << "Quantized 10-8-3 Network, weights in [-6, 6): maximum output error " << err << std::endl;
+	failures += err < 0.05 ? 0 : 1;
+	for (int i = 0; i < net.getNumNeurons(); ++i) {
+		for (int j = 0; j < net.getGeneSize(); ++j) {
+			net.getNeuron(i)->setWeight(j, net.getNeuron(i)->getWeight(j) / 6.0);
+		}
+	}
+	err = quantizationError(net);
+	std::cout << "Quantized 10-8-3 Network, weights in [-1, 1): maximum output error " << err << std::endl;
+	failures += err < 0.01 ? 0 : 1;
+	return failures ? 1 : 0;
+}
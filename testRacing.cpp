@@ -0,0 +1,105 @@
+#include "Environment.hpp"
+#include "FeedForward.hpp"
+#include "NeuroEvolution.hpp"
+#include "Neuron.hpp"
+#include "Population.hpp"
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <boost/random.hpp>
+
+using namespace ESP;
+
+/*!
+ * Episodes of a fixed length whose reward per step is a quality in
+ * [0, 1] read from the first weight of every Neuron. A checkpoint
+ * every 10 steps bounds the final fitness by a reward of 1 for each
+ * remaining step. Counts the steps it really runs
+ */
+class Ramp : public Environment {
+public:
+	Ramp() : steps(0) { inputDimension = 2; outputDimension = 1; };
+	int steps;
+protected:
+	void setupInput(std::vector<double>& input) { input.assign(2, 0.0); };
+	double evalNet(Network* net) {
+		const int length = 100;
+		double quality = 0.0;
+		for (int i = 0; i < net->getNumNeurons(); ++i) {
+			quality += (net->getNeuron(i)->getWeight(0) + 6.0) / 12.0 / net->getNumNeurons();
+		}
+		double fit = 0.0;
+		for (int s = 0; s < length; ++s) {
+			if (s % 10 == 0 && !checkpoint(fit, fit + length - s)) {
+				return fit;
+			}
+			fit += quality;
+			++steps;
+		}
+		return fit;
+	};
+};
+
+int main() {
+	const int hidden = 3, size = 20, generations = 5;
+	boost::mt19937 rng(6);
+	Ramp envt;
+	NeuroEvolution ne(envt, &rng);
+	FeedForwardNetwork net(2, hidden, 1);
+	Neuron exemplar(net.getGeneSize());
+	std::vector<NeuronPop*> subpops;
+	for (int i = 0; i < hidden; ++i) {
+		subpops.push_back(new NeuronPop(size, exemplar));
+		subpops.back()->create(rng);
+	}
+	boost::uniform_int<> pick(0, size - 1);
+	int failures = 0, pruned = 0, evaluations = 0, saved = 0, wrongCutoff = 0;
+	for (int g = 0; g < generations; ++g) {
+		for (int i = 0; i < hidden; ++i) {
+			subpops[i]->evalReset();
+		}
+		for (int k = 0; k < 3 * size; ++k) {
+			for (int i = 0; i < hidden; ++i) {
+				net.setNeuron(subpops[i]->getIndividual(pick(rng)), i);
+			}
+			// Full evaluation first, then raced from the second generation on
+			ne.racing = false;
+			net.resetFitness();
+			int before = envt.steps;
+			ne.evaluateEpisodes(&net);
+			double full = net.getFitness();
+			int fullSteps = envt.steps - before;
+			if (g > 0) {
+				ne.racing = true;
+				net.resetFitness();
+				before = envt.steps;
+				ne.evaluateEpisodes(&net);
+				++evaluations;
+				if (envt.wasPruned()) {
+					++pruned;
+					saved += fullSteps - (envt.steps - before);
+					// Pruned only if it could not breed, and ranked below the cutoff
+					failures += full < ne.raceCutoff && net.getFitness() < ne.raceCutoff ? 0 : 1;
+				} else {
+					failures += net.getFitness() == full ? 0 : 1;
+				}
+			}
+			net.addFitness();
+		}
+		for (int i = 0; i < hidden; ++i) {
+			subpops[i]->qsortIndividuals();
+		}
+		ne.setRaceCutoff(subpops);
+		double lowest = subpops[0]->getBreedCutoff();
+		for (int i = 1; i < hidden; ++i) {
+			lowest = std::min(lowest, subpops[i]->getBreedCutoff());
+		}
+		wrongCutoff += ne.raceCutoff == lowest ? 0 : 1;
+	}
+	std::cout << "Racing against the breed cutoff: " << pruned << " of " << evaluations << " evaluations pruned, " << saved
+			  << " steps saved, " << failures << " wrongly pruned or scored, " << wrongCutoff << " wrong cutoffs" << std::endl;
+	for (int i = 0; i < hidden; ++i) {
+		delete subpops[i];
+	}
+	return failures || wrongCutoff || pruned == 0 || saved == 0 ? 1 : 0;
+}
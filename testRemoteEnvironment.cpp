@@ -0,0 +1,129 @@
+#include "FeedForward.hpp"
+#include "NeuroEvolution.hpp"
+#include "RemoteEnvironment.hpp"
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <set>
+#include <boost/thread/thread.hpp>
+
+using namespace ESP;
+
+/*!
+ * LocalSimulator served from a thread, so the test can see its state
+ */
+class ThreadSimulator : public LocalSimulator {
+public:
+	ThreadSimulator(int in, int out) : LocalSimulator(in, out), listener(-1) {};
+	bool listen(std::string path) {
+		sockaddr_un addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		strcpy(addr.sun_path, path.c_str());
+		unlink(path.c_str());
+		listener = socket(AF_UNIX, SOCK_STREAM, 0);
+		return listener >= 0 && bind(listener, (sockaddr*)&addr, sizeof(addr)) == 0 && ::listen(listener, 1) == 0;
+	};
+	void run() {
+		int fd = accept(listener, 0, 0);
+		close(listener);
+		serve(fd);
+		close(fd);
+	};
+	inline unsigned int getLiveEpisodes() { return state.size(); };
+	std::set<unsigned int> seeds;	///< Seeds of the seeded resets received
+protected:
+	// Same start for every unseeded episode, so results do not depend on episode numbers
+	void reset(int episode, const unsigned int* seed, double* obs) {
+		LocalSimulator::reset(episode, seed, obs);
+		if (seed) {
+			seeds.insert(*seed);
+		} else {
+			state[episode][0] = obs[0] = 0.1;
+		}
+	};
+private:
+	int listener;
+};
+
+/*!
+ * Evaluate nets through the pipelined batch path and one by one, and
+ * check that both give the same fitness and that the simulator keeps
+ * no state for finished or cut off episodes. With seeds the Networks
+ * are evaluated on common episodes, which must reach the simulator:
+ * one given seed, or more drawn by a NeuroEvolution
+ */
+static int check(int inputs, int outputs, int numNets, int groups, int lanes, int maxSteps, int seeds = 0) {
+	std::string path = "testRemoteEnvironment.sock";
+	ThreadSimulator sim(inputs, outputs);
+	if (!sim.listen(path)) {
+		std::cout << "Cannot listen on " << path << std::endl;
+		return 1;
+	}
+	boost::thread server(boost::bind(&ThreadSimulator::run, &sim));
+	int failures = 0;
+	{
+		RemoteEnvironment envt(path, groups, maxSteps, lanes);
+		boost::mt19937 stream(seeds);
+		NeuroEvolution ne(envt, &stream);
+		if (seeds > 1) {
+			ne.newEpisodeSeeds(seeds);
+		}
+		std::vector<Network*> nets;
+		for (int i = 0; i < numNets; ++i) {
+			nets.push_back(new FeedForwardNetwork(inputs, 3, outputs));
+			nets.back()->create();
+		}
+		const unsigned int seed = 12345;
+		if (seeds == 1) {
+			envt.evaluateNetworks(nets, seed);
+		} else {
+			envt.evaluateNetworks(nets);
+		}
+		std::vector<double> batched(numNets);
+		for (int i = 0; i < numNets; ++i) {
+			batched[i] = nets[i]->getFitness();
+			nets[i]->resetFitness();
+			if (seeds == 1) {
+				envt.evaluateNetwork(nets[i], seed);
+			} else {
+				envt.evaluateEpisodes(nets[i]);
+			}
+			if (nets[i]->getFitness() != batched[i]) {
+				++failures;
+			}
+		}
+		std::cout << numNets << " Networks with " << inputs << " inputs and " << outputs << " outputs, " << groups << " groups of "
+				  << lanes << (seeds == 1 ? " on a common episode: " : seeds ? " on common episodes: " : ": ") << failures << " differ between batched and single evaluation" << std::endl;
+		for (int i = 0; i < numNets; ++i) {
+			delete nets[i];
+		}
+	}
+	server.join();
+	unlink(path.c_str());
+	if (sim.getLiveEpisodes() != 0) {
+		std::cout << "Simulator kept " << sim.getLiveEpisodes() << " episodes" << std::endl;
+		++failures;
+	}
+	if ((int)sim.seeds.size() != seeds) {
+		std::cout << "Simulator saw " << sim.seeds.size() << " episode seeds" << std::endl;
+		++failures;
+	}
+	return failures;
+}
+
+int main() {
+	int failures = 0;
+	// One episode per group, so most episodes start in place of one that ended
+	failures += check(2, 1, 10, 2, 1, 1000);
+	failures += check(2, 1, 10, 3, 2, 1000, 1);
+	failures += check(2, 1, 10, 2, 3, 1000, 3);
+	// Frames of several megabytes, far larger than the socket buffers,
+	// and episodes cut off at maxSteps
+	failures += check(2000, 2000, 200, 2, 100, 20);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,91 @@
+#include "SparseNetwork.hpp"
+#include "SparseNeuron.hpp"
+#include "NeuroEvolution.hpp"
+#include "Environment.hpp"
+#include <iostream>
+#include <vector>
+#include <boost/random.hpp>
+
+using namespace ESP;
+
+/*!
+ * Environment that only hosts the crossover operators
+ */
+class NoTask : public Environment {
+public:
+	NoTask() { inputDimension = 1; outputDimension = 1; };
+protected:
+	void setupInput(std::vector<double>&) {};
+	double evalNet(Network*) { return 0.0; };
+};
+
+/*!
+ * Whether activateBatch on every row matches activate row by row
+ */
+static bool sameOutputs(SparseNetwork& net, int inputs, int outputs, int batch, boost::mt19937& rng) {
+	boost::uniform_real<> dist(-1.0, 1.0);
+	std::vector<double> in(batch * inputs), out;
+	for (unsigned int k = 0; k < in.size(); ++k) {
+		in[k] = dist(rng);
+	}
+	net.activateBatch(in, out, batch);
+	std::vector<double> row(inputs), single;
+	for (int b = 0; b < batch; ++b) {
+		row.assign(in.begin() + b * inputs, in.begin() + (b + 1) * inputs);
+		net.activate(row, single);
+		for (int j = 0; j < outputs; ++j) {
+			if (single[j] != out[b * outputs + j]) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+int main() {
+	const int inputs = 200, hidden = 6, outputs = 3, connections = 12, batch = 8, rounds = 100;
+	boost::mt19937 rng(11);
+	SparseNetwork net(inputs, hidden, outputs, connections);
+	net.create(rng);
+	boost::uniform_int<> unit(0, hidden - 1), change(0, 3), locus(0, inputs + outputs - 1);
+	int differ = 0;
+	for (int r = 0; r < rounds; ++r) {
+		// The CSR rows must follow mutation, rewiring and lesioning
+		SparseNeuron* n = static_cast<SparseNeuron*>(net.getNeuron(unit(rng)));
+		switch (change(rng)) {
+		case 0:
+			n->mutate(rng);
+			break;
+		case 1:
+			n->connect(locus(rng), 0.5);
+			break;
+		case 2:
+			if (n->getSize() > 0) {
+				n->disconnect(n->getIndex(0));
+			}
+			break;
+		default:
+			n->lesioned = !n->lesioned;
+		}
+		differ += sameOutputs(net, inputs, outputs, batch, rng) ? 0 : 1;
+	}
+	// Arithmetic crossover keeps the connections of each parent
+	NoTask envt;
+	NeuroEvolution ne(envt, &rng);
+	SparseNeuron p1(inputs + outputs, connections), p2(inputs + outputs, connections);
+	SparseNeuron c1(inputs + outputs, connections), c2(inputs + outputs, connections);
+	p1.create(rng);
+	p2.create(rng);
+	ne.crossoverArithmetic(&p1, &p2, &c1, &c2);
+	bool support = c1.getSize() == p1.getSize() && c2.getSize() == p2.getSize();
+	for (unsigned int k = 0; support && k < c1.getSize(); ++k) {
+		support = c1.getIndex(k) == p1.getIndex(k);
+	}
+	for (unsigned int k = 0; support && k < c2.getSize(); ++k) {
+		support = c2.getIndex(k) == p2.getIndex(k);
+	}
+	std::cout << rounds << " changes to a " << inputs << "-" << hidden << "-" << outputs << " sparse Network: " << differ
+			  << " differ between CSR and single activation; crossover " << (support ? "keeps" : "changes")
+			  << " the parents' connections" << std::endl;
+	return differ == 0 && support ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+#include "FeedForward.hpp"
+#include "Neuron.hpp"
+#include "Environment.hpp"
+#include "NeuroEvolution.hpp"
+#include "Surrogate.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <boost/random/mersenne_twister.hpp>
+
+using namespace ESP;
+
+/*!
+ * Fitness is a fixed linear function of the weights
+ * Counts the Networks it really evaluates. When racing, the final
+ * fitness is reported at a checkpoint, so Networks that cannot beat
+ * the cutoff are pruned
+ */
+class LinearEnvironment : public Environment {
+public:
+	LinearEnvironment(int size) : evaluations(0), coeff(size) {
+		for (int i = 0; i < size; ++i) {
+			coeff[i] = 2.0 * std::rand() / RAND_MAX - 1.0;
+		}
+	};
+	int evaluations;
+protected:
+	void setupInput(std::vector<double>&) {};
+	double evalNet(Network* net) {
+		++evaluations;
+		double fit = 20.0;
+		int k = 0;
+		for (int i = 0; i < net->getNumNeurons(); ++i) {
+			for (unsigned int j = 0; j < net->getNeuron(i)->getSize(); ++j) {
+				fit += coeff[k++] * net->getNeuron(i)->getWeight(j);
+			}
+		}
+		if (!checkpoint(0.0, fit)) {
+			return 0.0;
+		}
+		return fit;
+	};
+private:
+	std::vector<double> coeff;
+};
+
+/*!
+ * Screen generations of random Networks
+ */
+static void run(Surrogate& surrogate, Environment& envt, FeedForwardNetwork& exemplar, int generations, int candidates, double fraction) {
+	boost::mt19937 rng(2);
+	for (int g = 0; g < generations; ++g) {
+		std::vector<Network*> nets(candidates);
+		for (int c = 0; c < candidates; ++c) {
+			nets[c] = exemplar.clone();
+			nets[c]->create();
+			for (int i = 0; i < nets[c]->getNumNeurons(); ++i) {
+				for (unsigned int j = 0; j < nets[c]->getNeuron(i)->getSize(); ++j) {
+					nets[c]->getNeuron(i)->setWeight(j, 2.0 * std::rand() / RAND_MAX - 1.0);
+				}
+			}
+		}
+		surrogate.screen(nets, fraction, envt, rng);
+		for (int c = 0; c < candidates; ++c) {
+			delete nets[c];
+		}
+	}
+}
+
+int main() {
+	const int generations = 20, candidates = 40;
+	const double fraction = 0.25;
+	std::srand(1);
+	FeedForwardNetwork exemplar(4, 3, 1);
+	LinearEnvironment envt(exemplar.getNumNeurons() * exemplar.getGeneSize());
+	Surrogate surrogate;
+	run(surrogate, envt, exemplar, generations, candidates, fraction);
+	int total = generations * candidates;
+	std::cout << "Surrogate with fraction " << fraction << " and " << surrogate.explore << " explored: " << envt.evaluations << " of " << total
+			  << " Networks evaluated, rank correlation " << surrogate.getRankCorrelation()
+			  << ", mean error " << surrogate.getError() << "; ";
+	int failures = 0;
+	failures += envt.evaluations < total / 2 ? 0 : 1;
+	failures += surrogate.getRankCorrelation() > 0.5 ? 0 : 1;
+	// Racing against the median fitness prunes about half the evaluations,
+	// which must not be used as observations
+	LinearEnvironment racing(exemplar.getNumNeurons() * exemplar.getGeneSize());
+	NeuroEvolution ne(racing);
+	ne.racing = true;
+	ne.raceCutoff = 20.0;
+	Surrogate pruned;
+	run(pruned, racing, exemplar, generations, candidates, fraction);
+	std::cout << "racing: " << ne.getPruned() << " of " << racing.evaluations << " evaluations pruned, "
+			  << pruned.getObservations() << " observed, rank correlation " << pruned.getRankCorrelation() << std::endl;
+	failures += ne.getPruned() > 0 && pruned.getObservations() == racing.evaluations - ne.getPruned() ? 0 : 1;
+	failures += pruned.getRankCorrelation() > 0.5 ? 0 : 1;
+	return failures ? 1 : 0;
+}